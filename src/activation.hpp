@@ -0,0 +1,238 @@
+#pragma once
+#include <cstddef>
+#include <type_traits>
+#include "kernels.hpp"
+#include "math.hpp"
+#include "matrix.hpp"
+#include "simd.hpp"
+
+/**
+ * Activation policies for the layers of a `NeuralNetwork`, which decide the
+ * function every neuron applies to its weighted input.
+ *
+ * Every policy has a `forward()` that applies the activation to the weighted
+ * inputs of a layer, and a `derivative()` that computes its derivative from
+ * the outputs of `forward()` alone, so backpropagation never has to keep the
+ * weighted inputs around. The derivatives are expressions, so multiplying
+ * them into the errors is fused into a single vectorized pass. They refer to
+ * the output, which has to outlive them.
+ *
+ * Apart from the sigmoid and tanh, which run on the dispatched sigmoid
+ * kernel, the activations are `map()`s over packets and need no `exp` at all.
+ *
+ * The softmax is the exception. Every one of its outputs depends on all of
+ * the inputs, so it has no derivative per entry, and it can only be used for
+ * the output layer, see `isSoftmax`.
+ */
+namespace Activation {
+    /**
+     * The logistic function `1 / (1 + e^-x)`, with outputs in (0, 1). This
+     * is the default.
+     */
+    struct Sigmoid {
+        /**
+         * Applies the sigmoid to every entry, see `Math::sigmoid()`.
+         *
+         * @tparam N The number of rows.
+         * @tparam M The number of columns.
+         * @param x The weighted inputs.
+         * @param accuracy Whether to use the exact or the approximate sigmoid.
+         * @return The outputs.
+         */
+        template<size_t N, size_t M>
+        static Matrix::Matrix<double, N, M> forward(const Matrix::Matrix<double, N, M>& x, const Kernels::Accuracy accuracy) {
+            return Math::sigmoid(x, accuracy);
+        }
+
+        /**
+         * Computes `y * (1 - y)` for every output, see
+         * `Math::sigmoidDerivative()`.
+         *
+         * @tparam N The number of rows.
+         * @tparam M The number of columns.
+         * @param y The outputs of `forward()`.
+         * @return An expression for the derivative at every entry.
+         */
+        template<size_t N, size_t M>
+        static auto derivative(const Matrix::Matrix<double, N, M>& y) {
+            return Math::sigmoidDerivative(y);
+        }
+    };
+
+    /**
+     * The hyperbolic tangent, with outputs in (-1, 1). It's computed as
+     * `2 * sigmoid(2x) - 1`, so it runs on the same kernel as the sigmoid.
+     */
+    struct Tanh {
+        /**
+         * Applies the hyperbolic tangent to every entry.
+         *
+         * @tparam N The number of rows.
+         * @tparam M The number of columns.
+         * @param x The weighted inputs.
+         * @param accuracy Whether to use the exact or the approximate sigmoid.
+         * @return The outputs.
+         */
+        template<size_t N, size_t M>
+        static Matrix::Matrix<double, N, M> forward(const Matrix::Matrix<double, N, M>& x, const Kernels::Accuracy accuracy) {
+            Matrix::Matrix<double, N, M> result = 2.0 * x;
+            Kernels::sigmoid<double>(result.view(), result.view(), accuracy);
+            return result.map([](const auto& s) { return 2.0 * s - 1.0; });
+        }
+
+        /**
+         * Computes `1 - y^2` for every output.
+         *
+         * @tparam N The number of rows.
+         * @tparam M The number of columns.
+         * @param y The outputs of `forward()`.
+         * @return An expression for the derivative at every entry.
+         */
+        template<size_t N, size_t M>
+        static auto derivative(const Matrix::Matrix<double, N, M>& y) {
+            return y.map([](const auto& v) { return 1.0 - v * v; });
+        }
+    };
+
+    /**
+     * The rectified linear unit `max(x, 0)`. It costs a single instruction
+     * per packet, and its outputs are zero for about half the neurons.
+     */
+    struct Relu {
+        /**
+         * Applies `max(x, 0)` to every entry.
+         *
+         * @tparam N The number of rows.
+         * @tparam M The number of columns.
+         * @param x The weighted inputs.
+         * @return The outputs.
+         */
+        template<size_t N, size_t M>
+        static Matrix::Matrix<double, N, M> forward(const Matrix::Matrix<double, N, M>& x, const Kernels::Accuracy) {
+            return x.map([](const auto& v) { return Simd::max(v, 0.0); });
+        }
+
+        /**
+         * Computes 1 for every positive output and 0 for every other one.
+         *
+         * @tparam N The number of rows.
+         * @tparam M The number of columns.
+         * @param y The outputs of `forward()`.
+         * @return An expression for the derivative at every entry.
+         */
+        template<size_t N, size_t M>
+        static auto derivative(const Matrix::Matrix<double, N, M>& y) {
+            return y.map([](const auto& v) { return Simd::step(v); });
+        }
+    };
+
+    /**
+     * The leaky rectified linear unit, `x` for positive inputs and
+     * `slope * x` for the others. Unlike the ReLU, its gradient never
+     * vanishes, so neurons can't get stuck at zero.
+     */
+    struct LeakyRelu {
+        /**
+         * The slope for negative inputs, which has to be in (0, 1).
+         */
+        static constexpr double slope = 0.01;
+
+        /**
+         * Applies `max(x, slope * x)` to every entry.
+         *
+         * @tparam N The number of rows.
+         * @tparam M The number of columns.
+         * @param x The weighted inputs.
+         * @return The outputs.
+         */
+        template<size_t N, size_t M>
+        static Matrix::Matrix<double, N, M> forward(const Matrix::Matrix<double, N, M>& x, const Kernels::Accuracy) {
+            return x.map([](const auto& v) { return Simd::max(v, slope * v); });
+        }
+
+        /**
+         * Computes 1 for every positive output and `slope` for every other
+         * one. The outputs have the signs of the inputs, so they tell the two
+         * apart.
+         *
+         * @tparam N The number of rows.
+         * @tparam M The number of columns.
+         * @param y The outputs of `forward()`.
+         * @return An expression for the derivative at every entry.
+         */
+        template<size_t N, size_t M>
+        static auto derivative(const Matrix::Matrix<double, N, M>& y) {
+            return y.map([](const auto& v) { return slope + (1.0 - slope) * Simd::step(v); });
+        }
+    };
+
+    /**
+     * The piecewise linear approximation of the sigmoid,
+     * `min(max(x / 5 + 1 / 2, 0), 1)`. Its outputs are in [0, 1] like
+     * those of the sigmoid, without the `exp`.
+     */
+    struct HardSigmoid {
+        /**
+         * Applies the hard sigmoid to every entry.
+         *
+         * @tparam N The number of rows.
+         * @tparam M The number of columns.
+         * @param x The weighted inputs.
+         * @return The outputs.
+         */
+        template<size_t N, size_t M>
+        static Matrix::Matrix<double, N, M> forward(const Matrix::Matrix<double, N, M>& x, const Kernels::Accuracy) {
+            return x.map([](const auto& v) { return Simd::min(Simd::max(0.2 * v + 0.5, 0.0), 1.0); });
+        }
+
+        /**
+         * Computes 1/5 for every output strictly between 0 and 1, where the
+         * function is linear, and 0 for every clamped one.
+         *
+         * @tparam N The number of rows.
+         * @tparam M The number of columns.
+         * @param y The outputs of `forward()`.
+         * @return An expression for the derivative at every entry.
+         */
+        template<size_t N, size_t M>
+        static auto derivative(const Matrix::Matrix<double, N, M>& y) {
+            return y.map([](const auto& v) { return 0.2 * Simd::step(v) * Simd::step(1.0 - v); });
+        }
+    };
+
+    /**
+     * The softmax `e^x / sum(e^x)` of every column, which turns the weighted
+     * inputs of the output layer into a probability distribution.
+     *
+     * It's trained with the cross-entropy loss instead of the squared error.
+     * The gradient of the cross-entropy at the weighted inputs of a softmax
+     * is `output - label`, with no derivative to multiply in. That requires
+     * the labels to be probability distributions, too.
+     */
+    struct Softmax {
+        /**
+         * Applies the softmax to every column, see `Kernels::softmax()`.
+         *
+         * @tparam N The number of rows.
+         * @tparam M The number of columns.
+         * @param x The weighted inputs.
+         * @param accuracy Whether to use the exact or the approximate `exp`.
+         * @return The outputs.
+         */
+        template<size_t N, size_t M>
+        static Matrix::Matrix<double, N, M> forward(const Matrix::Matrix<double, N, M>& x, const Kernels::Accuracy accuracy) {
+            Matrix::Matrix<double, N, M> result;
+            Kernels::softmax<double>(x.view(), result.view(), accuracy);
+            return result;
+        }
+    };
+
+    /**
+     * True if `A` is the softmax, whose output layer is trained with the
+     * cross-entropy loss and its fused gradient.
+     *
+     * @tparam A The activation policy.
+     */
+    template<typename A>
+    constexpr bool isSoftmax = std::is_same<A, Softmax>::value;
+} // Activation
@@ -0,0 +1,207 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <new>
+#include <string>
+#include <sys/mman.h>
+
+namespace Allocator {
+    /**
+     * The alignment of every buffer we hand out. This is the size of a cache
+     * line, which is also the width of an AVX-512 register, so a buffer (and
+     * every padded row inside of it) can be loaded without splitting lines.
+     */
+    constexpr size_t cacheLine = 64;
+
+    /**
+     * The size of a huge page on x86-64. Buffers that ask for huge pages are
+     * only backed by them if they're at least this large.
+     */
+    constexpr size_t hugePageSize = 2 * 1024 * 1024;
+
+    /**
+     * Gets the number of bytes currently allocated in blocks that asked for,
+     * and are large enough to get, huge pages.
+     *
+     * @return The counter of requested bytes.
+     */
+    inline std::atomic<size_t>& hugePageBytesRequested() {
+        static std::atomic<size_t> bytes{0};
+        return bytes;
+    }
+
+    /**
+     * How much of this process' memory the kernel has actually backed with
+     * huge pages, split into pages from the reserved pool (`MAP_HUGETLB`) and
+     * transparent huge pages.
+     */
+    struct HugePageUsage {
+        size_t explicitBytes = 0;
+        size_t transparentBytes = 0;
+    };
+
+    /**
+     * Rounds `size` up to the next multiple of `multiple`.
+     *
+     * @param size The size to round.
+     * @param multiple The multiple to round to.
+     * @return The rounded size.
+     */
+    constexpr size_t roundUp(const size_t size, const size_t multiple) {
+        return (size + multiple - 1) / multiple * multiple;
+    }
+
+    /**
+     * Whether a buffer of `bytes` bytes that asked for huge pages is large
+     * enough to get them. This has to give the same answer for `allocate()`
+     * and `deallocate()`, since it decides how the memory is released.
+     *
+     * @param bytes The size of the buffer.
+     * @param hugePages Whether the buffer asked for huge pages.
+     * @return True if the buffer is mapped directly from the kernel.
+     */
+    constexpr bool isMapped(const size_t bytes, const bool hugePages) {
+        return hugePages && bytes >= hugePageSize;
+    }
+
+    /**
+     * Maps an anonymous region of `bytes` bytes that starts on a huge page
+     * boundary. We first try the reserved huge page pool. If there isn't one,
+     * we map normal pages, trim the region so that it's aligned, and ask the
+     * kernel to back it with transparent huge pages.
+     *
+     * @param bytes The size of the region, a multiple of `hugePageSize`.
+     * @return The start of the region, or nullptr if mapping failed.
+     */
+    inline void* mapHugePages(const size_t bytes) {
+#ifdef MAP_HUGETLB
+        void* pointer = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+        if (pointer != MAP_FAILED) return pointer;
+#endif
+
+        // Over-allocate by one huge page so that we can cut off the unaligned
+        // head and tail of the region.
+        const size_t padded = bytes + hugePageSize;
+        void* region = mmap(nullptr, padded, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (region == MAP_FAILED) return nullptr;
+
+        auto start = reinterpret_cast<uintptr_t>(region);
+        auto aligned = roundUp(start, hugePageSize);
+        if (aligned > start) munmap(region, aligned - start);
+        if (start + padded > aligned + bytes) munmap(reinterpret_cast<void*>(aligned + bytes), start + padded - aligned - bytes);
+
+        region = reinterpret_cast<void*>(aligned);
+#ifdef MADV_HUGEPAGE
+        madvise(region, bytes, MADV_HUGEPAGE);
+#endif
+        return region;
+    }
+
+    /**
+     * Allocates a block of at least `bytes` bytes aligned to `alignment`. If
+     * `hugePages` is set and the block is large enough, it is mapped directly
+     * with huge pages instead, see `mapHugePages()`.
+     *
+     * @param bytes The size of the block.
+     * @param alignment The alignment, a power of two.
+     * @param hugePages Whether to try to back the block with huge pages.
+     * @throws std::bad_alloc
+     * @return Pointer to the block.
+     */
+    inline void* allocate(const size_t bytes, const size_t alignment, const bool hugePages = false) {
+        void* pointer = isMapped(bytes, hugePages)
+            ? mapHugePages(roundUp(bytes, hugePageSize))
+            : std::aligned_alloc(alignment, roundUp(bytes == 0 ? 1 : bytes, alignment));
+
+        if (pointer == nullptr) throw std::bad_alloc{};
+        if (isMapped(bytes, hugePages)) hugePageBytesRequested() += roundUp(bytes, hugePageSize);
+        return pointer;
+    }
+
+    /**
+     * Releases a block from `allocate()`. The size and huge page flag must be
+     * the ones it was allocated with.
+     *
+     * @param pointer Pointer to the block.
+     * @param bytes The size of the block.
+     * @param hugePages Whether the block asked for huge pages.
+     */
+    inline void deallocate(void* pointer, const size_t bytes, const bool hugePages = false) noexcept {
+        if (pointer == nullptr) return;
+        if (!isMapped(bytes, hugePages)) {
+            std::free(pointer);
+            return;
+        }
+
+        munmap(pointer, roundUp(bytes, hugePageSize));
+        hugePageBytesRequested() -= roundUp(bytes, hugePageSize);
+    }
+
+    /**
+     * Reads how much of this process' memory the kernel has actually backed
+     * with huge pages. Neither `MADV_HUGEPAGE` nor a successful mapping
+     * guarantees anything about the pages we end up with, so this is the
+     * number that tells whether asking for huge pages worked.
+     *
+     * @return The huge page usage, all zeros if it can't be determined.
+     */
+    inline HugePageUsage hugePageUsage() {
+        HugePageUsage usage;
+        std::ifstream stream{"/proc/self/smaps_rollup"};
+        std::string key;
+        size_t kilobytes;
+
+        while (stream >> key) {
+            if (key == "AnonHugePages:" && stream >> kilobytes) usage.transparentBytes = kilobytes * 1024;
+            else if (key == "Private_Hugetlb:" && stream >> kilobytes) usage.explicitBytes = kilobytes * 1024;
+        }
+
+        return usage;
+    }
+
+    /**
+     * Standard library compatible allocator handing out blocks aligned to
+     * `Alignment`, and optionally backed by huge pages. Used for containers
+     * holding large data sets.
+     *
+     * @tparam T The element type.
+     * @tparam Alignment The alignment of every block.
+     * @tparam HugePages Whether large blocks are backed by huge pages.
+     */
+    template<typename T, size_t Alignment = cacheLine, bool HugePages = false>
+    struct AlignedAllocator {
+        using value_type = T;
+
+        template<typename U>
+        struct rebind {
+            using other = AlignedAllocator<U, Alignment, HugePages>;
+        };
+
+        AlignedAllocator() noexcept = default;
+
+        template<typename U>
+        AlignedAllocator(const AlignedAllocator<U, Alignment, HugePages>&) noexcept {
+        }
+
+        T* allocate(const size_t count) {
+            return static_cast<T*>(Allocator::allocate(count * sizeof(T), Alignment, HugePages));
+        }
+
+        void deallocate(T* pointer, const size_t count) noexcept {
+            Allocator::deallocate(pointer, count * sizeof(T), HugePages);
+        }
+
+        template<typename U>
+        bool operator==(const AlignedAllocator<U, Alignment, HugePages>&) const noexcept {
+            return true;
+        }
+
+        template<typename U>
+        bool operator!=(const AlignedAllocator<U, Alignment, HugePages>&) const noexcept {
+            return false;
+        }
+    };
+} // Allocator
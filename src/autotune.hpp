@@ -0,0 +1,174 @@
+#pragma once
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <limits>
+#include <ostream>
+#include <thread>
+#include <vector>
+#include "dynamic.hpp"
+#include "kernels.hpp"
+#include "threads.hpp"
+#include "tuning.hpp"
+
+namespace Tuning {
+    /**
+     * The shape of a weight matrix to tune the kernels for.
+     */
+    struct Shape {
+        size_t rows;
+        size_t cols;
+    };
+
+    /**
+     * The number of columns of the matrix products used to tune the cache
+     * blocking, which is about the size of a minibatch.
+     */
+    constexpr size_t tuningBatch = 64;
+
+    /**
+     * Times a function. It's run over and over for a few milliseconds, and
+     * the fastest run counts, which filters out most of the noise from other
+     * processes.
+     *
+     * @tparam F The function type.
+     * @param function The function to time.
+     * @return The fastest run in seconds.
+     */
+    template<typename F>
+    double measure(const F& function) {
+        using Clock = std::chrono::steady_clock;
+
+        function();
+        double best = std::numeric_limits<double>::max();
+        const auto deadline = Clock::now() + std::chrono::milliseconds(20);
+        do {
+            const auto start = Clock::now();
+            function();
+            best = std::min(best, std::chrono::duration<double>(Clock::now() - start).count());
+        } while (Clock::now() < deadline);
+
+        return best;
+    }
+
+    /**
+     * Tries every candidate for one parameter while the others stay fixed,
+     * and keeps the fastest.
+     *
+     * @tparam F The benchmark type.
+     * @tparam A The type of the function applying the parameter.
+     * @param name The name of the parameter, for the log.
+     * @param parameter The parameter to tune.
+     * @param candidates The values to try.
+     * @param benchmark The function to time with every value.
+     * @param log Where to report the results.
+     * @param apply Called after the parameter changed, to apply it.
+     */
+    template<typename F, typename A>
+    void tune(
+        const char* name,
+        size_t& parameter,
+        const std::vector<size_t>& candidates,
+        const F& benchmark,
+        std::ostream& log,
+        const A& apply
+    ) {
+        size_t best = parameter;
+        double bestTime = std::numeric_limits<double>::max();
+
+        for (const size_t candidate : candidates) {
+            parameter = candidate;
+            apply();
+            const double time = measure(benchmark);
+            if (time < bestTime) {
+                best = candidate;
+                bestTime = time;
+            }
+        }
+
+        parameter = best;
+        apply();
+        log << "  " << name << ": " << best << " (" << bestTime * 1e6 << "us)" << std::endl;
+    }
+
+    /**
+     * Measures the best kernel parameters for the weight matrices of a
+     * network and makes them the current ones.
+     *
+     * Every parameter is tuned on the work it affects, one at a time, in the
+     * order the later ones depend on the earlier ones. Threads and the
+     * threshold for using them are tuned on a training step, which is a
+     * matrix-vector product, a transposed one and a rank-1 update per weight
+     * matrix. The number of rows per matrix-vector block is tuned on the
+     * products alone, and the cache blocking on matrix products with
+     * `tuningBatch` columns. Those are narrower than any panel of B, so `nc`
+     * keeps its default.
+     *
+     * @param shapes The shapes of the weight matrices.
+     * @param log Where to report the results.
+     * @return The tuned parameters.
+     */
+    inline Parameters autotune(const std::vector<Shape>& shapes, std::ostream& log) {
+        using Matrix::DynamicMatrix;
+        using Matrix::randomDynamicMatrix;
+
+        struct Operands {
+            DynamicMatrix<double> weights;
+            DynamicMatrix<double> input;
+            DynamicMatrix<double> output;
+            DynamicMatrix<double> errors;
+            DynamicMatrix<double> inputErrors;
+            DynamicMatrix<double> batch;
+            DynamicMatrix<double> batchOutput;
+        };
+
+        std::vector<Operands> operands;
+        for (const Shape& shape : shapes) {
+            operands.push_back({
+                randomDynamicMatrix(shape.rows, shape.cols),
+                randomDynamicMatrix(shape.cols, 1),
+                DynamicMatrix<double>(shape.rows, 1),
+                randomDynamicMatrix(shape.rows, 1),
+                DynamicMatrix<double>(shape.cols, 1),
+                randomDynamicMatrix(shape.cols, tuningBatch),
+                DynamicMatrix<double>(shape.rows, tuningBatch),
+            });
+        }
+
+        const auto products = [&] {
+            for (auto& o : operands) {
+                Kernels::gemv<double>(o.weights.view(), o.input.view(), o.output.view());
+                Kernels::gemv<double>(Kernels::Operation::Transpose, o.weights.view(), o.errors.view(), o.inputErrors.view());
+            }
+        };
+
+        // The rank-1 update uses a tiny rate so that the weights stay put no
+        // matter how often it runs.
+        const auto step = [&] {
+            products();
+            for (auto& o : operands) o.weights.ger(1e-12, o.errors, o.input);
+        };
+
+        const auto batches = [&] {
+            for (auto& o : operands) Kernels::gemm<double>(o.weights.view(), o.batch.view(), o.batchOutput.view());
+        };
+
+        Parameters& tuning = parameters();
+        const auto nothing = [] {};
+        const auto resize = [&] { Threads::setThreads(tuning.threads); };
+
+        std::vector<size_t> threads;
+        const size_t cores = std::max<size_t>(std::thread::hardware_concurrency(), 1);
+        for (size_t count = 1; count < cores; count *= 2) threads.push_back(count);
+        threads.push_back(cores);
+
+        log << "Autotuning kernels:" << std::endl;
+        tune("threads", tuning.threads, threads, step, log, resize);
+        tune("parallel work", tuning.parallelWork, {1 << 12, 1 << 14, 1 << 16, 1 << 18, std::numeric_limits<size_t>::max()}, step, log, nothing);
+        tune("gemv rows", tuning.gemvRows, {2, 4, 8}, products, log, nothing);
+        tune("mc", tuning.mc, {64, 128, 256}, batches, log, nothing);
+        tune("kc", tuning.kc, {128, 256, 384, 512}, batches, log, nothing);
+
+        return tuning;
+    }
+} // Tuning
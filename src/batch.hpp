@@ -0,0 +1,96 @@
+#pragma once
+#include <cstddef>
+#include "layout.hpp"
+#include "matrix.hpp"
+#include "storage.hpp"
+#include "view.hpp"
+
+namespace Matrix {
+    /**
+     * Class representing a batch of `B` column vectors of size `N`, stored
+     * side by side as the columns of one `N * B` matrix.
+     *
+     * Where a vector of column vectors scatters the samples across the heap,
+     * a batch keeps them in one block, and a layer can be applied to the
+     * whole batch with a single matrix product instead of `B` matrix-vector
+     * products. Every weight is then loaded once per batch rather than once
+     * per sample.
+     *
+     * A batch is a matrix, so everything that works on an `N * B` matrix
+     * works on a batch. On top of that, every sample can be read and written
+     * in place through a view of its column. In a column-major batch every
+     * sample is contiguous.
+     *
+     * @tparam T The entry type.
+     * @tparam N The size of every column vector.
+     * @tparam B The number of column vectors.
+     * @tparam S The storage policy.
+     * @tparam L The layout policy.
+     */
+    template<typename T, size_t N, size_t B, typename S = Storage::Automatic, typename L = Layout::RowMajor>
+    class Batch : public Matrix<T, N, B, S, L> {
+    public:
+        using Matrix<T, N, B, S, L>::Matrix;
+
+        /**
+         * The number of column vectors in the batch.
+         */
+        static constexpr size_t Size = B;
+
+        /**
+         * Gets a view of column vector `j`, without copying it. Its entries
+         * are `stride()` apart in a row-major batch, and contiguous in a
+         * column-major one.
+         *
+         * @param j The index of the column vector.
+         * @throws std::out_of_range
+         * @return The `N * 1` view of the column vector.
+         */
+        MatrixView<T> column(const size_t j) {
+            return columnView(this->view(), j);
+        }
+
+        /**
+         * Gets a read-only view of column vector `j`, without copying it.
+         *
+         * @param j The index of the column vector.
+         * @throws std::out_of_range
+         * @return The `N * 1` view of the column vector.
+         */
+        ConstMatrixView<T> column(const size_t j) const {
+            return columnView(this->view(), j);
+        }
+
+        /**
+         * Copies a column vector into column `j` of the batch.
+         *
+         * @tparam S2 The storage policy of the column vector.
+         * @param j The index of the column vector.
+         * @param vector The column vector to copy.
+         * @throws std::out_of_range
+         */
+        template<typename S2>
+        void setColumn(const size_t j, const Matrix<T, N, 1, S2>& vector) {
+            const MatrixView<T> target = column(j);
+            for (size_t i = 0; i < N; ++i) target(i, 0) = vector(i, 0);
+        }
+
+    private:
+        /**
+         * Gets the view of column vector `j` out of the view of the stored
+         * matrix, where it is a column if the batch is row-major and a row
+         * if it's column-major.
+         *
+         * @tparam U The entry type of the view.
+         * @param stored The view of the stored matrix.
+         * @param j The index of the column vector.
+         * @throws std::out_of_range
+         * @return The `N * 1` view of the column vector.
+         */
+        template<typename U>
+        static MatrixView<U> columnView(const MatrixView<U> stored, const size_t j) {
+            if constexpr (Layout::isRowMajor<L>) return stored.colRange(j, j + 1);
+            else return {stored.rowRange(j, j + 1).data(), N, 1, 1};
+        }
+    };
+} // Matrix
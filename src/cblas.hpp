@@ -0,0 +1,138 @@
+#pragma once
+#if defined(KERNELS_CBLAS)
+#include <cblas.h>
+#include <cstddef>
+#include "kernels.hpp"
+
+/**
+ * Runs the matrix products on an external CBLAS library like OpenBLAS, which
+ * gives a vendor-tuned baseline to compare the native kernels against.
+ *
+ * Only built with `KERNELS_CBLAS`, see `make BLAS=<library>`. The wrappers
+ * below have the signatures of the native kernels, so `install()` can swap
+ * them into a table of kernels. Everything else in the table stays native.
+ */
+namespace Cblas {
+    /**
+     * Converts a kernel operation to the CBLAS one.
+     *
+     * @param op The operation.
+     * @return The CBLAS operation.
+     */
+    inline CBLAS_TRANSPOSE transpose(const Kernels::Operation op) {
+        return op == Kernels::Operation::Normal ? CblasNoTrans : CblasTrans;
+    }
+
+    /**
+     * Computes `C += op(A) * op(B)` with `cblas_sgemm`, see
+     * `Kernels::gemm()`. Empty products return right away, since CBLAS
+     * rejects the zero strides empty views may have.
+     */
+    inline void gemm(
+        const Kernels::Operation opA,
+        const Kernels::Operation opB,
+        const size_t n,
+        const size_t k,
+        const size_t m,
+        const float* a,
+        const size_t lda,
+        const float* b,
+        const size_t ldb,
+        float* c,
+        const size_t ldc
+    ) {
+        if (n == 0 || k == 0 || m == 0) return;
+        cblas_sgemm(CblasRowMajor, transpose(opA), transpose(opB), n, m, k, 1, a, lda, b, ldb, 1, c, ldc);
+    }
+
+    /**
+     * Computes `C += op(A) * op(B)` with `cblas_dgemm`, see
+     * `Kernels::gemm()`.
+     */
+    inline void gemm(
+        const Kernels::Operation opA,
+        const Kernels::Operation opB,
+        const size_t n,
+        const size_t k,
+        const size_t m,
+        const double* a,
+        const size_t lda,
+        const double* b,
+        const size_t ldb,
+        double* c,
+        const size_t ldc
+    ) {
+        if (n == 0 || k == 0 || m == 0) return;
+        cblas_dgemm(CblasRowMajor, transpose(opA), transpose(opB), n, m, k, 1, a, lda, b, ldb, 1, c, ldc);
+    }
+
+    /**
+     * Computes `y += A * x` with `cblas_sgemv`, see `Kernels::gemv()`.
+     */
+    inline void gemv(const size_t n, const size_t k, const float* a, const size_t lda, const float* x, float* y) {
+        if (n == 0 || k == 0) return;
+        cblas_sgemv(CblasRowMajor, CblasNoTrans, n, k, 1, a, lda, x, 1, 1, y, 1);
+    }
+
+    /**
+     * Computes `y += A * x` with `cblas_dgemv`, see `Kernels::gemv()`.
+     */
+    inline void gemv(const size_t n, const size_t k, const double* a, const size_t lda, const double* x, double* y) {
+        if (n == 0 || k == 0) return;
+        cblas_dgemv(CblasRowMajor, CblasNoTrans, n, k, 1, a, lda, x, 1, 1, y, 1);
+    }
+
+    /**
+     * Computes `y += A^T * x` with `cblas_sgemv`, see
+     * `Kernels::gemvTransposed()`.
+     */
+    inline void gemvTransposed(const size_t n, const size_t k, const float* a, const size_t lda, const float* x, float* y) {
+        if (n == 0 || k == 0) return;
+        cblas_sgemv(CblasRowMajor, CblasTrans, n, k, 1, a, lda, x, 1, 1, y, 1);
+    }
+
+    /**
+     * Computes `y += A^T * x` with `cblas_dgemv`, see
+     * `Kernels::gemvTransposed()`.
+     */
+    inline void gemvTransposed(const size_t n, const size_t k, const double* a, const size_t lda, const double* x, double* y) {
+        if (n == 0 || k == 0) return;
+        cblas_dgemv(CblasRowMajor, CblasTrans, n, k, 1, a, lda, x, 1, 1, y, 1);
+    }
+
+    /**
+     * Computes `A += alpha * x * y^T` with `cblas_sger`, see
+     * `Kernels::ger()`.
+     */
+    inline void ger(const size_t n, const size_t m, const float alpha, const float* x, const float* y, float* a, const size_t lda) {
+        if (n == 0 || m == 0) return;
+        cblas_sger(CblasRowMajor, n, m, alpha, x, 1, y, 1, a, lda);
+    }
+
+    /**
+     * Computes `A += alpha * x * y^T` with `cblas_dger`, see
+     * `Kernels::ger()`.
+     */
+    inline void ger(const size_t n, const size_t m, const double alpha, const double* x, const double* y, double* a, const size_t lda) {
+        if (n == 0 || m == 0) return;
+        cblas_dger(CblasRowMajor, n, m, alpha, x, 1, y, 1, a, lda);
+    }
+
+    /**
+     * Replaces the products of a table of kernels with the wrappers above.
+     * CBLAS libraries thread their own products, so the table is marked as
+     * threaded and the view kernels stop splitting them.
+     *
+     * @tparam T The entry type, float or double.
+     * @param table The table to change.
+     */
+    template<typename T>
+    void install(Kernels::Table<T>& table) {
+        table.gemm = &gemm;
+        table.gemv = &gemv;
+        table.gemvTransposed = &gemvTransposed;
+        table.ger = &ger;
+        table.threaded = true;
+    }
+} // Cblas
+#endif
@@ -0,0 +1,96 @@
+#include <cstdlib>
+#include <cstring>
+#include "dispatch.hpp"
+#if defined(KERNELS_CBLAS)
+#include "cblas.hpp"
+#endif
+
+#if defined(KERNELS_DISPATCH)
+namespace Dispatch {
+    const char* name(const Level level) {
+        switch (level) {
+            case Level::Avx512: return "avx512";
+            case Level::Avx2: return "avx2";
+            default: return "sse2";
+        }
+    }
+
+    Level supported() {
+        // Besides the feature bits, the builtin also checks that the
+        // operating system saves the wider registers on context switches.
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx512f")) return Level::Avx512;
+        if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) return Level::Avx2;
+        return Level::Sse2;
+    }
+
+    Level selected() {
+        static const Level level = [] {
+            const Level best = supported();
+            const char* variable = std::getenv("NN_ISA");
+            if (variable == nullptr) return best;
+
+            // Levels above the supported one would crash on the first
+            // kernel, so those are ignored.
+            for (const Level level : {Level::Sse2, Level::Avx2, Level::Avx512}) {
+                if (std::strcmp(variable, name(level)) == 0 && level <= best) return level;
+            }
+            return best;
+        }();
+        return level;
+    }
+
+    /**
+     * Gets the kernels compiled for a level.
+     *
+     * @tparam T The entry type.
+     * @param level The level.
+     * @return The table of kernels.
+     */
+    template<typename T>
+    Kernels::Table<T> table(const Level level) {
+        switch (level) {
+            case Level::Avx512: return levelTable<Level::Avx512, T>();
+            case Level::Avx2: return levelTable<Level::Avx2, T>();
+            default: return levelTable<Level::Sse2, T>();
+        }
+    }
+} // Dispatch
+#endif
+
+#if defined(KERNELS_DISPATCH) || defined(KERNELS_CBLAS)
+namespace Kernels {
+    /**
+     * Builds the table of kernels for this run: the native kernels of the
+     * selected level, or of this translation unit without dispatch, with the
+     * products of the CBLAS library swapped in if there is one.
+     *
+     * @tparam T The entry type.
+     * @return The table of kernels.
+     */
+    template<typename T>
+    Table<T> selectedTable() {
+#if defined(KERNELS_DISPATCH)
+        Table<T> table = Dispatch::table<T>(Dispatch::selected());
+#else
+        Table<T> table = compiledTable<T>();
+#endif
+#if defined(KERNELS_CBLAS)
+        Cblas::install(table);
+#endif
+        return table;
+    }
+
+    template<>
+    const Table<float>& dispatchedTable<float>() {
+        static const Table<float> table = selectedTable<float>();
+        return table;
+    }
+
+    template<>
+    const Table<double>& dispatchedTable<double>() {
+        static const Table<double> table = selectedTable<double>();
+        return table;
+    }
+} // Kernels
+#endif
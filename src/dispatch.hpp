@@ -0,0 +1,90 @@
+#pragma once
+#include "kernels.hpp"
+
+/**
+ * Picks the kernels for the CPU the binary runs on.
+ *
+ * With `KERNELS_DISPATCH` (the default in the Makefile), the kernels are
+ * compiled once for every level below, each in its own translation unit
+ * (`dispatch_sse2.cpp`, `dispatch_avx2.cpp`, `dispatch_avx512.cpp`). At
+ * startup we check which levels the CPU supports and route every dispatched
+ * kernel through the table of the best one. The `NN_ISA` environment variable
+ * forces a lower level, which is useful for comparing them on one machine.
+ *
+ * Without `KERNELS_DISPATCH`, every translation unit uses the kernels
+ * compiled for its own target flags, see `SIMD_LEVEL`.
+ */
+namespace Dispatch {
+    /**
+     * The instruction set levels the kernels are compiled for.
+     */
+    enum class Level {
+        Sse2,
+        Avx2,
+        Avx512,
+    };
+
+    /**
+     * Gets the name of a level, as used by `NN_ISA`.
+     *
+     * @param level The level.
+     * @return One of "sse2", "avx2" or "avx512".
+     */
+    const char* name(Level level);
+
+    /**
+     * Gets the best level the CPU and the operating system support, based on
+     * the `cpuid` feature flags.
+     *
+     * @return The best supported level.
+     */
+    Level supported();
+
+    /**
+     * Gets the level the kernels run on. This is the level from `NN_ISA` if
+     * it's set to a supported one, and `supported()` otherwise. It is decided
+     * the first time it's needed and never changes afterwards.
+     *
+     * @return The selected level.
+     */
+    Level selected();
+
+    /**
+     * Gets the kernels compiled for level `L`. Defined in the translation
+     * unit of every level for floats and doubles.
+     *
+     * @tparam L The level.
+     * @tparam T The entry type.
+     * @return The table of kernels.
+     */
+    template<Level L, typename T>
+    Kernels::Table<T> levelTable();
+
+    /**
+     * Gets the name of the instruction set the matrix kernels run on, for
+     * reporting.
+     *
+     * @return The name of the instruction set.
+     */
+    inline const char* isa() {
+#if defined(KERNELS_DISPATCH)
+        return name(selected());
+#else
+        return Simd::isa();
+#endif
+    }
+
+    /**
+     * Gets the name of the library the matrix products run on, for
+     * reporting.
+     *
+     * @return "cblas" with `KERNELS_CBLAS`, "native" otherwise.
+     */
+    inline const char* products() {
+#if defined(KERNELS_CBLAS)
+        return "cblas";
+#else
+        return "native";
+#endif
+    }
+} // Dispatch
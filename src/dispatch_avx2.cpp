@@ -0,0 +1,49 @@
+#if defined(KERNELS_DISPATCH)
+// Only the kernels may be compiled for AVX2. Anything else that ends up in
+// this translation unit, like the standard library or the thread pool, is
+// shared with the rest of the binary, and the linker is free to keep this
+// copy of it. So every header the kernels need is included before the target
+// region, which leaves just the kernels themselves inside of it.
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <fstream>
+#include <immintrin.h>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "allocator.hpp"
+#include "threads.hpp"
+#include "tuning.hpp"
+#include "view.hpp"
+
+#define SIMD_LEVEL 2
+#if defined(__clang__)
+#pragma clang attribute push(__attribute__((target("avx2,fma"))), apply_to = function)
+#else
+#pragma GCC push_options
+#pragma GCC target("avx2,fma")
+#endif
+#include "kernels.hpp"
+#if defined(__clang__)
+#pragma clang attribute pop
+#else
+#pragma GCC pop_options
+#endif
+
+#include "dispatch.hpp"
+
+namespace Dispatch {
+    template<>
+    Kernels::Table<float> levelTable<Level::Avx2, float>() {
+        return Kernels::compiledTable<float>();
+    }
+
+    template<>
+    Kernels::Table<double> levelTable<Level::Avx2, double>() {
+        return Kernels::compiledTable<double>();
+    }
+} // Dispatch
+#endif
@@ -0,0 +1,47 @@
+#if defined(KERNELS_DISPATCH)
+// Like `dispatch_avx2.cpp`, every header but the kernels is included before
+// the target region, so that nothing shared with the rest of the binary is
+// compiled for AVX-512.
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <fstream>
+#include <immintrin.h>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "allocator.hpp"
+#include "threads.hpp"
+#include "tuning.hpp"
+#include "view.hpp"
+
+#define SIMD_LEVEL 3
+#if defined(__clang__)
+#pragma clang attribute push(__attribute__((target("avx512f,avx2,fma"))), apply_to = function)
+#else
+#pragma GCC push_options
+#pragma GCC target("avx512f,avx2,fma")
+#endif
+#include "kernels.hpp"
+#if defined(__clang__)
+#pragma clang attribute pop
+#else
+#pragma GCC pop_options
+#endif
+
+#include "dispatch.hpp"
+
+namespace Dispatch {
+    template<>
+    Kernels::Table<float> levelTable<Level::Avx512, float>() {
+        return Kernels::compiledTable<float>();
+    }
+
+    template<>
+    Kernels::Table<double> levelTable<Level::Avx512, double>() {
+        return Kernels::compiledTable<double>();
+    }
+} // Dispatch
+#endif
@@ -0,0 +1,18 @@
+#if defined(KERNELS_DISPATCH)
+// SSE2 is part of every x86-64 CPU, so the baseline flags already compile
+// the kernels for it.
+#define SIMD_LEVEL 1
+#include "dispatch.hpp"
+
+namespace Dispatch {
+    template<>
+    Kernels::Table<float> levelTable<Level::Sse2, float>() {
+        return Kernels::compiledTable<float>();
+    }
+
+    template<>
+    Kernels::Table<double> levelTable<Level::Sse2, double>() {
+        return Kernels::compiledTable<double>();
+    }
+} // Dispatch
+#endif
@@ -0,0 +1,677 @@
+#pragma once
+#include <cmath>
+#include <cstddef>
+#include <random>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "allocator.hpp"
+#include "kernels.hpp"
+#include "layout.hpp"
+#include "matrix.hpp"
+#include "storage.hpp"
+#include "view.hpp"
+
+namespace Matrix {
+    template<typename T>
+    class TransposedDynamicMatrix;
+
+    /**
+     * Class representing a matrix with entries of type `T` whose size is only
+     * known at runtime, for shapes that come from data or configuration
+     * rather than from the code.
+     *
+     * It runs on the same kernels as `Matrix`, through views. The entries are
+     * stored on the heap in one block, with every row padded to a whole
+     * number of cache lines like `Storage::Aligned`, so moving and swapping
+     * are O(1).
+     *
+     * Since the dimensions aren't part of the type, mismatched operands are
+     * only caught at runtime, by throwing `std::invalid_argument`. For the
+     * same reason element-wise operations are evaluated eagerly, a register
+     * at a time, rather than built up into expressions.
+     *
+     * @tparam T The Matrix entry type.
+     */
+    template<typename T>
+    class DynamicMatrix {
+    public:
+        /**
+         * Constructs an empty `0 * 0` matrix.
+         */
+        DynamicMatrix() = default;
+
+        /**
+         * Constructs a `rows * cols` matrix filled with zeros.
+         *
+         * @param rows The number of rows.
+         * @param cols The number of columns.
+         */
+        DynamicMatrix(const size_t rows, const size_t cols) :
+            _rows{rows},
+            _cols{cols},
+            _stride{Storage::paddedStride<T>(cols)},
+            _entries(rows * _stride, T{}) {
+        }
+
+        /**
+         * Copies a matrix of compile time size.
+         *
+         * @tparam N The number of rows.
+         * @tparam M The number of columns.
+         * @tparam S The storage policy.
+         * @tparam L The layout policy.
+         * @param matrix The matrix to copy.
+         */
+        template<size_t N, size_t M, typename S, typename L>
+        DynamicMatrix(const Matrix<T, N, M, S, L>& matrix) : DynamicMatrix{N, M} {
+            if constexpr (Layout::isRowMajor<L>) Kernels::map(matrix.view(), view(), [](const auto& entry) { return entry; });
+            else Kernels::transpose(matrix.view(), view());
+        }
+
+        /**
+         * Copies this matrix into a matrix of compile time size.
+         *
+         * @tparam N The number of rows.
+         * @tparam M The number of columns.
+         * @tparam S The storage policy.
+         * @tparam L The layout policy.
+         * @throws std::invalid_argument
+         * @return The matrix of compile time size.
+         */
+        template<size_t N, size_t M, typename S = Storage::Automatic, typename L = Layout::RowMajor>
+        Matrix<T, N, M, S, L> toMatrix() const {
+            Matrix<T, N, M, S, L> result{};
+            if constexpr (Layout::isRowMajor<L>) Kernels::map(view(), result.view(), [](const auto& entry) { return entry; });
+            else Kernels::transpose(view(), result.view());
+            return result;
+        }
+
+        size_t rows() const noexcept {
+            return _rows;
+        }
+
+        size_t cols() const noexcept {
+            return _cols;
+        }
+
+        /**
+         * Gets the distance between the starts of two consecutive rows in
+         * `data()`.
+         *
+         * @return The row stride.
+         */
+        size_t stride() const noexcept {
+            return _stride;
+        }
+
+        T* data() noexcept {
+            return _entries.data();
+        }
+
+        const T* data() const noexcept {
+            return _entries.data();
+        }
+
+        /**
+         * Gets the entry at `(i, j)` without any bounds checking.
+         *
+         * @param i The row index.
+         * @param j The column index.
+         * @return The entry at `(i, j)`.
+         */
+        const T& operator()(const size_t i, const size_t j) const noexcept {
+            return _entries[i * _stride + j];
+        }
+
+        /**
+         * Gets a mutable reference to the entry at `(i, j)` without any bounds
+         * checking.
+         *
+         * @param i The row index.
+         * @param j The column index.
+         * @return The entry at `(i, j)`.
+         */
+        T& operator()(const size_t i, const size_t j) noexcept {
+            return _entries[i * _stride + j];
+        }
+
+        /**
+         * Gets the row of the matrix located at index `idx`.
+         *
+         * @param idx The index of the row.
+         * @throws std::out_of_range
+         * @return The `idx`-th row.
+         */
+        T* operator[](const size_t idx) {
+            if (idx >= _rows) throw std::out_of_range{"`idx` is out of range!"};
+            return data() + idx * _stride;
+        }
+
+        /**
+         * Gets a constant pointer to the row of the matrix.
+         *
+         * @param idx The index of the row.
+         * @throws std::out_of_range
+         * @return The `idx`-th row.
+         */
+        const T* operator[](const size_t idx) const {
+            if (idx >= _rows) throw std::out_of_range{"`idx` is out of range!"};
+            return data() + idx * _stride;
+        }
+
+        /**
+         * Gets a view of the whole matrix.
+         *
+         * @return The view of this matrix.
+         */
+        MatrixView<T> view() noexcept {
+            return {data(), _rows, _cols, _stride};
+        }
+
+        /**
+         * Gets a read-only view of the whole matrix.
+         *
+         * @return The view of this matrix.
+         */
+        ConstMatrixView<T> view() const noexcept {
+            return {data(), _rows, _cols, _stride};
+        }
+
+        /**
+         * Applies a function to every entry, see `Kernels::map()`.
+         *
+         * @tparam F The function type.
+         * @param function The function to apply.
+         * @return A new matrix holding the results.
+         */
+        template<typename F>
+        DynamicMatrix map(F function) const {
+            DynamicMatrix result{_rows, _cols};
+            Kernels::map(view(), result.view(), function);
+            return result;
+        }
+
+        /**
+         * Combines every entry with the corresponding entry of a matrix of
+         * the same size, see `Kernels::zip()`.
+         *
+         * @tparam F The function type.
+         * @param matrix The matrix to combine with.
+         * @param function Function taking an entry of this matrix and one of `matrix`.
+         * @throws std::invalid_argument
+         * @return A new matrix holding the results.
+         */
+        template<typename F>
+        DynamicMatrix zip(const DynamicMatrix& matrix, F function) const {
+            DynamicMatrix result{_rows, _cols};
+            Kernels::zip(view(), matrix.view(), result.view(), function);
+            return result;
+        }
+
+        /**
+         * Adds a matrix of the same size to this matrix in place.
+         *
+         * @param matrix The matrix to add.
+         * @throws std::invalid_argument
+         * @return This matrix.
+         */
+        DynamicMatrix& operator+=(const DynamicMatrix& matrix) {
+            return axpy(1, matrix);
+        }
+
+        /**
+         * Subtracts a matrix of the same size from this matrix in place.
+         *
+         * @param matrix The matrix to subtract.
+         * @throws std::invalid_argument
+         * @return This matrix.
+         */
+        DynamicMatrix& operator-=(const DynamicMatrix& matrix) {
+            return axpy(-1, matrix);
+        }
+
+        /**
+         * Multiplies every entry of this matrix by a scalar in place.
+         *
+         * @param scalar The scalar.
+         * @return This matrix.
+         */
+        DynamicMatrix& operator*=(const T scalar) {
+            return scale(scalar);
+        }
+
+        /**
+         * Adds `alpha * matrix` to this matrix in place.
+         *
+         * @param alpha The scalar to multiply `matrix` by.
+         * @param matrix The matrix to add.
+         * @throws std::invalid_argument
+         * @return This matrix.
+         */
+        DynamicMatrix& axpy(const T alpha, const DynamicMatrix& matrix) {
+            Kernels::axpy(alpha, matrix.view(), view());
+            return *this;
+        }
+
+        /**
+         * Adds the outer product `alpha * x * y^T` to this matrix in place,
+         * see `Matrix::ger()`.
+         *
+         * @param alpha The scalar to multiply the outer product by.
+         * @param x The column with one entry per row.
+         * @param y The column with one entry per column.
+         * @throws std::invalid_argument
+         * @return This matrix.
+         */
+        DynamicMatrix& ger(const T alpha, const DynamicMatrix& x, const DynamicMatrix& y) {
+            Kernels::ger(alpha, x.view(), y.view(), view());
+            return *this;
+        }
+
+        /**
+         * Multiplies every entry of this matrix by a scalar in place.
+         *
+         * @param alpha The scalar.
+         * @return This matrix.
+         */
+        DynamicMatrix& scale(const T alpha) {
+            Kernels::scale(alpha, view());
+            return *this;
+        }
+
+        /**
+         * Sets every entry of this matrix to the same value.
+         *
+         * @param value The value.
+         * @return This matrix.
+         */
+        DynamicMatrix& fill(const T value) {
+            Kernels::fill(value, view());
+            return *this;
+        }
+
+        /**
+         * Transposes the current matrix without copying it, see
+         * `Matrix::transpose()`.
+         *
+         * @return The transpose of this matrix.
+         */
+        TransposedDynamicMatrix<T> transpose() const & noexcept {
+            return TransposedDynamicMatrix<T>{*this};
+        }
+
+        /**
+         * Transposes a temporary matrix into a new matrix.
+         *
+         * @return The transpose of this matrix.
+         */
+        DynamicMatrix transpose() const && {
+            DynamicMatrix result{_cols, _rows};
+            Kernels::transpose(view(), result.view());
+            return result;
+        }
+
+        /**
+         * Transposes this square matrix in place.
+         *
+         * @param threads The number of threads, or 0 to decide based on the size.
+         * @throws std::invalid_argument
+         * @return This matrix.
+         */
+        DynamicMatrix& transposeInPlace(const size_t threads = 0) {
+            Kernels::transposeInPlace(view(), threads);
+            return *this;
+        }
+
+        T sum() const {
+            return Kernels::sum<T>(view());
+        }
+
+        /**
+         * Computes the dot product with a matrix of the same size.
+         *
+         * @param matrix The other matrix.
+         * @throws std::invalid_argument
+         * @return The dot product.
+         */
+        T dot(const DynamicMatrix& matrix) const {
+            return Kernels::dot<T>(view(), matrix.view());
+        }
+
+        T squaredNorm() const {
+            return Kernels::dot<T>(view(), view());
+        }
+
+        T norm() const {
+            return std::sqrt(squaredNorm());
+        }
+
+        /**
+         * Gets the largest entry of a non-empty matrix.
+         *
+         * @throws std::invalid_argument
+         * @return The largest entry.
+         */
+        T max() const {
+            const size_t index = argmax();
+            return (*this)(index / _cols, index % _cols);
+        }
+
+        /**
+         * Finds the largest entry of a non-empty matrix, see
+         * `Matrix::argmax()`.
+         *
+         * @throws std::invalid_argument
+         * @return The index `i * cols() + j` of the first occurrence of the largest entry.
+         */
+        size_t argmax() const {
+            return Kernels::argmax<T>(view());
+        }
+
+        /**
+         * Finds the `k` largest entries of the matrix, see `Matrix::topK()`.
+         *
+         * @param k The number of entries to find.
+         * @throws std::invalid_argument
+         * @return The indices of the entries, from the largest to the smallest.
+         */
+        std::vector<size_t> topK(const size_t k) const {
+            std::vector<size_t> indices(k);
+            Kernels::topK<T>(view(), k, indices.data());
+            return indices;
+        }
+
+        /**
+         * Swaps the entries of two matrices, which only swaps pointers.
+         *
+         * @param other The matrix to swap with.
+         */
+        void swap(DynamicMatrix& other) noexcept {
+            std::swap(_rows, other._rows);
+            std::swap(_cols, other._cols);
+            std::swap(_stride, other._stride);
+            _entries.swap(other._entries);
+        }
+
+    private:
+        size_t _rows = 0;
+        size_t _cols = 0;
+        size_t _stride = 0;
+        std::vector<T, Allocator::AlignedAllocator<T>> _entries;
+    };
+
+    /**
+     * Zero-copy transpose of a `DynamicMatrix`, which must not outlive it.
+     * Like `TransposedMatrix`, it only exists to route products to the
+     * transposed kernels.
+     *
+     * @tparam T The Matrix entry type.
+     */
+    template<typename T>
+    class TransposedDynamicMatrix {
+    public:
+        explicit TransposedDynamicMatrix(const DynamicMatrix<T>& matrix) noexcept : _matrix{matrix} {
+        }
+
+        size_t rows() const noexcept {
+            return _matrix.cols();
+        }
+
+        size_t cols() const noexcept {
+            return _matrix.rows();
+        }
+
+        const T& operator()(const size_t i, const size_t j) const noexcept {
+            return _matrix(j, i);
+        }
+
+        /**
+         * Transposes the transpose, which is just the original matrix.
+         *
+         * @return The original matrix.
+         */
+        const DynamicMatrix<T>& transpose() const noexcept {
+            return _matrix;
+        }
+
+        /**
+         * Copies the transpose into a new matrix.
+         *
+         * @param threads The number of threads, or 0 to decide based on the size.
+         * @return A new matrix holding the transpose.
+         */
+        DynamicMatrix<T> materialize(const size_t threads = 0) const {
+            DynamicMatrix<T> result{rows(), cols()};
+            Kernels::transpose(view(), result.view(), threads);
+            return result;
+        }
+
+        /**
+         * Gets a view of the original, untransposed matrix.
+         *
+         * @return The view of the original matrix.
+         */
+        ConstMatrixView<T> view() const noexcept {
+            return _matrix.view();
+        }
+
+    private:
+        const DynamicMatrix<T>& _matrix;
+    };
+
+    /**
+     * Swaps the entries of two matrices.
+     *
+     * @tparam T The Matrix entry type.
+     * @param matrix1 The first matrix.
+     * @param matrix2 The second matrix.
+     */
+    template<typename T>
+    void swap(DynamicMatrix<T>& matrix1, DynamicMatrix<T>& matrix2) noexcept {
+        matrix1.swap(matrix2);
+    }
+
+    /**
+     * Combines two matrices of the same size with an element-wise kernel of
+     * `Kernels::Table`, like `Table::add`, which runs on the instruction set
+     * picked at startup, see `Kernels::elementwise()`.
+     *
+     * @tparam T The Matrix entry type.
+     * @param matrix1 The first matrix.
+     * @param matrix2 The second matrix.
+     * @param kernel The kernel computing `n` contiguous entries.
+     * @throws std::invalid_argument
+     * @return A new matrix holding the results.
+     */
+    template<typename T>
+    DynamicMatrix<T> elementwise(
+        const DynamicMatrix<T>& matrix1,
+        const DynamicMatrix<T>& matrix2,
+        void (*kernel)(size_t, const T*, const T*, T*)
+    ) {
+        DynamicMatrix<T> result{matrix1.rows(), matrix1.cols()};
+        Kernels::elementwise(matrix1.view(), matrix2.view(), result.view(), kernel);
+        return result;
+    }
+
+    /**
+     * Adds two matrices of the same size.
+     *
+     * @tparam T The Matrix entry type.
+     * @param matrix1 The first matrix.
+     * @param matrix2 The second matrix.
+     * @throws std::invalid_argument
+     * @return A new matrix holding `matrix1 + matrix2`.
+     */
+    template<typename T>
+    DynamicMatrix<T> operator+(const DynamicMatrix<T>& matrix1, const DynamicMatrix<T>& matrix2) {
+        return elementwise(matrix1, matrix2, Kernels::kernels<T>().add);
+    }
+
+    /**
+     * Subtracts `matrix2` from `matrix1`, which must have the same size.
+     *
+     * @tparam T The Matrix entry type.
+     * @param matrix1 The first matrix.
+     * @param matrix2 The second matrix.
+     * @throws std::invalid_argument
+     * @return A new matrix holding `matrix1 - matrix2`.
+     */
+    template<typename T>
+    DynamicMatrix<T> operator-(const DynamicMatrix<T>& matrix1, const DynamicMatrix<T>& matrix2) {
+        return elementwise(matrix1, matrix2, Kernels::kernels<T>().subtract);
+    }
+
+    /**
+     * Calculates the Hadamard product of two matrices of the same size.
+     *
+     * @tparam T The Matrix entry type.
+     * @param matrix1 The first matrix.
+     * @param matrix2 The second matrix.
+     * @throws std::invalid_argument
+     * @return A new matrix holding the element-wise product.
+     */
+    template<typename T>
+    DynamicMatrix<T> operator^(const DynamicMatrix<T>& matrix1, const DynamicMatrix<T>& matrix2) {
+        return elementwise(matrix1, matrix2, Kernels::kernels<T>().multiply);
+    }
+
+    /**
+     * Multiplies every entry of a matrix by a scalar.
+     *
+     * @tparam T The Matrix entry type.
+     * @param scalar The scalar.
+     * @param matrix The matrix.
+     * @return A new matrix holding `scalar * matrix`.
+     */
+    template<typename T>
+    DynamicMatrix<T> operator*(const std::common_type_t<T> scalar, const DynamicMatrix<T>& matrix) {
+        DynamicMatrix<T> result = matrix;
+        result.scale(scalar);
+        return result;
+    }
+
+    /**
+     * Negates every entry of a matrix.
+     *
+     * @tparam T The Matrix entry type.
+     * @param matrix The matrix.
+     * @return A new matrix holding `-matrix`.
+     */
+    template<typename T>
+    DynamicMatrix<T> operator-(const DynamicMatrix<T>& matrix) {
+        return T{-1} * matrix;
+    }
+
+    /**
+     * Computes `op(matrix1) * op(matrix2)` with the blocked kernel, or with
+     * the vector kernels if `matrix2` is a single column.
+     *
+     * @tparam T The Matrix entry type.
+     * @param op1 How to read `matrix1`.
+     * @param matrix1 The view of the first matrix.
+     * @param op2 How to read `matrix2`.
+     * @param matrix2 The view of the second matrix.
+     * @throws std::invalid_argument
+     * @return A new matrix holding the matrix product.
+     */
+    template<typename T>
+    DynamicMatrix<T> multiply(
+        const Kernels::Operation op1,
+        const ConstMatrixView<T> matrix1,
+        const Kernels::Operation op2,
+        const ConstMatrixView<T> matrix2
+    ) {
+        const size_t rows = op1 == Kernels::Operation::Normal ? matrix1.rows() : matrix1.cols();
+        const size_t cols = op2 == Kernels::Operation::Normal ? matrix2.cols() : matrix2.rows();
+        DynamicMatrix<T> result{rows, cols};
+
+        if (op2 == Kernels::Operation::Normal && cols == 1) Kernels::gemv(op1, matrix1, matrix2, result.view());
+        else Kernels::gemm(op1, matrix1, op2, matrix2, result.view());
+
+        return result;
+    }
+
+    /**
+     * Multiplies two matrices, where the columns of `matrix1` must match the
+     * rows of `matrix2`.
+     *
+     * @tparam T The Matrix entry type.
+     * @param matrix1 The first matrix.
+     * @param matrix2 The second matrix.
+     * @throws std::invalid_argument
+     * @return A new matrix holding the matrix product.
+     */
+    template<typename T>
+    DynamicMatrix<T> operator*(const DynamicMatrix<T>& matrix1, const DynamicMatrix<T>& matrix2) {
+        return multiply<T>(Kernels::Operation::Normal, matrix1.view(), Kernels::Operation::Normal, matrix2.view());
+    }
+
+    /**
+     * Computes `matrix1^T * matrix2` without transposing `matrix1`.
+     *
+     * @tparam T The Matrix entry type.
+     * @param matrix1 The transposed first matrix.
+     * @param matrix2 The second matrix.
+     * @throws std::invalid_argument
+     * @return A new matrix holding the matrix product.
+     */
+    template<typename T>
+    DynamicMatrix<T> operator*(const TransposedDynamicMatrix<T>& matrix1, const DynamicMatrix<T>& matrix2) {
+        return multiply<T>(Kernels::Operation::Transpose, matrix1.view(), Kernels::Operation::Normal, matrix2.view());
+    }
+
+    /**
+     * Computes `matrix1 * matrix2^T` without transposing `matrix2`.
+     *
+     * @tparam T The Matrix entry type.
+     * @param matrix1 The first matrix.
+     * @param matrix2 The transposed second matrix.
+     * @throws std::invalid_argument
+     * @return A new matrix holding the matrix product.
+     */
+    template<typename T>
+    DynamicMatrix<T> operator*(const DynamicMatrix<T>& matrix1, const TransposedDynamicMatrix<T>& matrix2) {
+        return multiply<T>(Kernels::Operation::Normal, matrix1.view(), Kernels::Operation::Transpose, matrix2.view());
+    }
+
+    /**
+     * Computes `matrix1^T * matrix2^T` without transposing either matrix.
+     *
+     * @tparam T The Matrix entry type.
+     * @param matrix1 The transposed first matrix.
+     * @param matrix2 The transposed second matrix.
+     * @throws std::invalid_argument
+     * @return A new matrix holding the matrix product.
+     */
+    template<typename T>
+    DynamicMatrix<T> operator*(const TransposedDynamicMatrix<T>& matrix1, const TransposedDynamicMatrix<T>& matrix2) {
+        return multiply<T>(Kernels::Operation::Transpose, matrix1.view(), Kernels::Operation::Transpose, matrix2.view());
+    }
+
+    /**
+     * Constructs a matrix of size `rows * cols` with all values initialized
+     * to a random real value between -1 and 1, like `randomMatrix()`.
+     *
+     * @param rows The number of rows.
+     * @param cols The number of columns.
+     * @return A new matrix with random values between -1 and 1.
+     */
+    inline DynamicMatrix<double> randomDynamicMatrix(const size_t rows, const size_t cols) {
+        std::random_device rd;
+        std::mt19937 gen{rd()};
+        std::uniform_real_distribution<> dis(-1, 1);
+
+        DynamicMatrix<double> result{rows, cols};
+        for (size_t i = 0; i < rows; ++i) {
+            for (size_t j = 0; j < cols; ++j) {
+                result(i, j) = dis(gen);
+                if (result(i, j) == 0) result(i, j) += 0.01;
+            }
+        }
+
+        return result;
+    }
+} // Matrix
@@ -0,0 +1,70 @@
+#pragma once
+#include <cstddef>
+#include <type_traits>
+#include "kernels.hpp"
+
+/**
+ * Layout policies for `Matrix`, which decide the order its entries are
+ * stored in.
+ *
+ * A column-major `N * M` matrix is stored exactly like the row-major
+ * `M * N` matrix of its transpose. So the kernels, which only know row-major
+ * views, are given the view of the stored matrix along with the
+ * `Kernels::Operation` that turns it back into the logical one. Every
+ * combination of layouts in a product is then one of the packing variants
+ * the kernels already have for transposed operands.
+ *
+ * Which layout is better depends on how a matrix is read. Products pack their
+ * operands, so they run equally fast on either. Reading a matrix one row or
+ * one column at a time, or copying it to another layout, is where the
+ * layout matters.
+ */
+namespace Layout {
+    /**
+     * Entry `(i, j)` is stored at `i * stride + j`, so every row is
+     * contiguous. This is the default.
+     */
+    struct RowMajor {
+        static constexpr Kernels::Operation operation = Kernels::Operation::Normal;
+
+        static constexpr size_t storedRows(const size_t rows, const size_t) {
+            return rows;
+        }
+
+        static constexpr size_t storedCols(const size_t, const size_t cols) {
+            return cols;
+        }
+
+        static constexpr size_t index(const size_t i, const size_t j, const size_t stride) {
+            return i * stride + j;
+        }
+    };
+
+    /**
+     * Entry `(i, j)` is stored at `j * stride + i`, so every column is
+     * contiguous.
+     */
+    struct ColumnMajor {
+        static constexpr Kernels::Operation operation = Kernels::Operation::Transpose;
+
+        static constexpr size_t storedRows(const size_t, const size_t cols) {
+            return cols;
+        }
+
+        static constexpr size_t storedCols(const size_t rows, const size_t) {
+            return rows;
+        }
+
+        static constexpr size_t index(const size_t i, const size_t j, const size_t stride) {
+            return j * stride + i;
+        }
+    };
+
+    /**
+     * True if `L` stores the rows contiguously.
+     *
+     * @tparam L The layout policy.
+     */
+    template<typename L>
+    constexpr bool isRowMajor = std::is_same<L, RowMajor>::value;
+} // Layout
@@ -1,14 +1,23 @@
+#include <algorithm>
 #include <chrono>
 #include <cstdio>
+#include <cstdlib>
 #include <cstring>
 #include <functional>
 #include <iostream>
 #include <sstream>
 #include <string>
+#include <thread>
 #include <vector>
+#include "activation.hpp"
+#include "allocator.hpp"
+#include "autotune.hpp"
+#include "dispatch.hpp"
 #include "math.hpp"
 #include "matrix.hpp"
 #include "neuralnet.hpp"
+#include "threads.hpp"
+#include "tuning.hpp"
 
 /**
  * Parses the current line as a training label. The training label contains the
@@ -17,10 +26,11 @@
  *
  * @tparam InputSize The size of the input layer.
  * @param line The current line to parse.
+ * @param distribution Whether the label has to be a probability distribution.
  * @return The parsed training label.
  */
 template<size_t InputSize, size_t OutputSize>
-NeuralNetwork::TrainingLabel<InputSize, OutputSize> parseInput(const std::string& line) {
+NeuralNetwork::TrainingLabel<InputSize, OutputSize> parseInput(const std::string& line, const bool distribution) {
     NeuralNetwork::TrainingLabel<InputSize, OutputSize> trainingLabel{};
     std::istringstream stream{line};
     std::string token;
@@ -32,11 +42,15 @@ NeuralNetwork::TrainingLabel<InputSize, OutputSize> parseInput(const std::string
     // Prepare label column vector. For index `i` corresponding to integers 0
     // through `OutputSize`, we assign 1 to the neuron that has the correct
     // output signal, and 0.01 to the neurons with the incorrect output signal.
+    // If the label has to be a probability distribution, like it does for a
+    // softmax output, the correct neuron gets what's left of 1 instead.
+    const double correct = distribution ? 1 - 0.01 * (OutputSize - 1) : 1;
     for (size_t i = 0; i < OutputSize; ++i) {
-        trainingLabel.label[i][0] = trainingLabel.value == i ? 1 : 0.01;
+        trainingLabel.label[i][0] = trainingLabel.value == i ? correct : 0.01;
     }
 
-    // Parse image data into column vector.
+    // Parse image data into column vector. The network adds
+    // `Math::pixelOffset` itself, so blank pixels stay 0.
     for (size_t i = 0; i < InputSize; ++i) {
         std::getline(stream, token, ',');
         int pixel = std::stoi(token);
@@ -50,14 +64,15 @@ NeuralNetwork::TrainingLabel<InputSize, OutputSize> parseInput(const std::string
  * Parses standard input line by line and builds a training data set.
  *
  * @tparam InputSize The size of the input layer.
+ * @param distribution Whether the labels have to be probability distributions.
  * @return The training data set.
  */
 template<size_t InputSize, size_t OutputSize>
-NeuralNetwork::TrainingSet<InputSize, OutputSize> parseTrainingSet() {
+NeuralNetwork::TrainingSet<InputSize, OutputSize> parseTrainingSet(const bool distribution) {
     NeuralNetwork::TrainingSet<InputSize, OutputSize> trainingSet{};
 
     for (std::string line; std::getline(std::cin, line); ) {
-        trainingSet.push_back(parseInput<InputSize, OutputSize>(line));
+        trainingSet.push_back(parseInput<InputSize, OutputSize>(line, distribution));
     }
 
     return trainingSet;
@@ -66,43 +81,53 @@ NeuralNetwork::TrainingSet<InputSize, OutputSize> parseTrainingSet() {
 /**
  * Counts the number of correct neural network predictions by iterating through
  * the training data set, querying the network, and comparing the result to the
- * expected value.
+ * expected value. The inputs are queried `BatchSize` at a time, see
+ * `NeuralNetwork::query()`.
  *
+ * @tparam BatchSize The number of inputs per query.
+ * @tparam Network The type of the neural network.
  * @tparam InputSize The size of the input layer.
- * @tparam HiddenSize The size of the hidden layer.
  * @tparam OutputSize The size of the output layer.
  * @param network The neural network.
  * @param trainingSet The training set.
  * @param verbose Flag to print verbose info or not.
  * @return The number of correct predictions.
  */
-template<size_t InputSize, size_t HiddenSize, size_t OutputSize>
+template<size_t BatchSize, typename Network, size_t InputSize, size_t OutputSize>
 size_t countCorrectPredictions(
-    const NeuralNetwork::NeuralNetwork<InputSize, HiddenSize, OutputSize>& network,
+    const Network& network,
     const NeuralNetwork::TrainingSet<InputSize, OutputSize>& trainingSet,
     const bool verbose
 ) {
     size_t count = 0;
     size_t labelNumber = 1;
     auto trainingSetSize = trainingSet.size();
+    NeuralNetwork::Batch<InputSize, BatchSize> inputs{};
 
-    for (const auto& trainingLabel : trainingSet) {
-        auto result = network.query(trainingLabel.input);
-        if (trainingLabel.value == result) count++;
-        if (!verbose) continue;
+    for (size_t begin = 0; begin < trainingSetSize; begin += BatchSize) {
+        // The last batch may not be full. Its leftover columns still hold
+        // inputs of the previous batch, and their results are ignored.
+        const size_t end = std::min(trainingSetSize, begin + BatchSize);
+        for (size_t i = begin; i < end; ++i) inputs.setColumn(i - begin, trainingSet[i].input);
+        const auto results = network.query(inputs);
 
-        // If verbose output is enabled, print out current label number and the
-        // number of matches, as well as their percentages out of the total.
-        std::printf(
-            "\rCounting Correct Predictions: %ld / %ld (%.2f%%), %ld matches (%.2f%%)",
-            labelNumber, trainingSetSize, Math::percentage(labelNumber, trainingSetSize),
-            count, Math::percentage(count, trainingSetSize)
-        );
-        // We flush the output so that the cursor stays at the end of the
-        // console. If this line is missing, the cursor will constantly appear
-        // to go back and forth.
-        std::cout << std::flush;
-        labelNumber++;
+        for (size_t i = begin; i < end; ++i) {
+            if (trainingSet[i].value == results[i - begin]) count++;
+            if (!verbose) continue;
+
+            // If verbose output is enabled, print out current label number and the
+            // number of matches, as well as their percentages out of the total.
+            std::printf(
+                "\rCounting Correct Predictions: %ld / %ld (%.2f%%), %ld matches (%.2f%%)",
+                labelNumber, trainingSetSize, Math::percentage(labelNumber, trainingSetSize),
+                count, Math::percentage(count, trainingSetSize)
+            );
+            // We flush the output so that the cursor stays at the end of the
+            // console. If this line is missing, the cursor will constantly appear
+            // to go back and forth.
+            std::cout << std::flush;
+            labelNumber++;
+        }
     }
 
     if (verbose) std::cout << std::endl;
@@ -134,12 +159,16 @@ std::chrono::milliseconds timeFunction(const std::function<void()>& func) {
  * @param The exe for this program.
  */
 void printHelp(const char* exe) {
-    std::cout << "Usage: " << exe << " [-v|-d|-l] < data/mnist_test.csv"
+    std::cout << "Usage: " << exe << " [-v|-d|-l|-a|-f|-s|-t <threads>] < data/mnist_test.csv"
               << std::endl << std::endl
               << "Flags:" << std::endl
               << "  -v - Enable verbose output." << std::endl
               << "  -d - Dump network weights after training." << std::endl
-              << "  -l - Load network weights from previous training." << std::endl;
+              << "  -l - Load network weights from previous training." << std::endl
+              << "  -a - Autotune the matrix kernels for this machine and save the result." << std::endl
+              << "  -f - Use the faster, approximate sigmoid (absolute error below 8.5e-7)." << std::endl
+              << "  -s - Use a softmax output layer trained with the cross-entropy loss." << std::endl
+              << "  -t - Number of threads for the matrix kernels (default: NN_THREADS or all cores)." << std::endl;
 }
 
 int main(const int argc, const char* argv[]) {
@@ -147,11 +176,21 @@ int main(const int argc, const char* argv[]) {
     bool verbose = false;
     bool dumpWeights = false;
     bool loadWeights = false;
+    bool autotune = false;
+    bool approximate = false;
+    bool softmax = false;
+    size_t threads = 0;
 
     for (int i = 1; i < argc; ++i) {
         if (std::strcmp(argv[i], "-v") == 0) verbose = true;
         else if (std::strcmp(argv[i], "-d") == 0) dumpWeights = true;
         else if (std::strcmp(argv[i], "-l") == 0) loadWeights = true;
+        else if (std::strcmp(argv[i], "-a") == 0) autotune = true;
+        else if (std::strcmp(argv[i], "-f") == 0) approximate = true;
+        else if (std::strcmp(argv[i], "-s") == 0) softmax = true;
+        else if (std::strcmp(argv[i], "-t") == 0 && i + 1 < argc && std::atoi(argv[i + 1]) > 0) {
+            threads = std::atoi(argv[++i]);
+        }
         else {
             // If we received an unrecognized flag, then we print the help
             // message and exit.
@@ -161,38 +200,80 @@ int main(const int argc, const char* argv[]) {
     }
 
     const std::string weightsFile = "weights.data";
+    const std::string tuningFile = "tuning.cache";
 
     // Neural network input paramters
     const size_t inputSize = 784;
     const size_t hiddenSize = 300;
     const size_t outputSize = 10;
     const double learningRate = 0.3;
+    // The gradient of a softmax output isn't damped by the derivative of a
+    // sigmoid, so it takes smaller steps.
+    const double softmaxLearningRate = 0.05;
+    const size_t batchSize = 64;
 
-    NeuralNetwork::NeuralNetwork<inputSize, hiddenSize, outputSize> network{learningRate, verbose};
+    // The kernel parameters are either measured now or loaded from an
+    // earlier run on this machine. An explicit thread count beats both.
+    const size_t cores = std::max<size_t>(std::thread::hardware_concurrency(), 1);
+    auto& tuning = Tuning::parameters();
+    std::string tuningSource = "defaults";
+    if (autotune) {
+        Tuning::autotune({{hiddenSize, inputSize}, {outputSize, hiddenSize}}, std::cout);
+        const bool saved = Tuning::save(tuningFile, tuning, Dispatch::isa(), cores);
+        tuningSource = saved ? "autotuned, saved to " + tuningFile : "autotuned";
+    } else if (Tuning::load(tuningFile, Dispatch::isa(), cores, Kernels::Blocking::MR, tuning)) {
+        tuningSource = "loaded from " + tuningFile;
+        if (tuning.threads != 0 && std::getenv("NN_THREADS") == nullptr) Threads::setThreads(tuning.threads);
+    }
+    if (threads != 0) Threads::setThreads(threads);
+
+    const auto accuracy = approximate ? Kernels::Accuracy::Approximate : Kernels::Accuracy::Exact;
     NeuralNetwork::TrainingSet<inputSize, outputSize> trainingSet;
 
     // Begin parsing, training, and matching. These are all long-running
     // computations, so we time their execution and print it out at the end for
     // statistics.
-    auto parseTime = timeFunction([&trainingSet]() {
-        trainingSet = parseTrainingSet<inputSize, outputSize>();
+    auto parseTime = timeFunction([&trainingSet, softmax]() {
+        trainingSet = parseTrainingSet<inputSize, outputSize>(softmax);
     });
 
-    auto trainTime = timeFunction([&network, &trainingSet, &weightsFile, loadWeights]() {
-        // If the load weights flag is passed and if the network is able to
-        // load from the file, then we can skip training.
-        if (loadWeights && network.loadWeightsFromFile(weightsFile)) return;
-        network.train(trainingSet);
-    });
+    // The output layer is part of the type of the network, but training and
+    // matching work the same with either one.
+    std::chrono::milliseconds trainTime;
+    std::chrono::milliseconds matchTime;
+    size_t matches;
+    NeuralNetwork::TrainingStats stats;
+    const auto run = [&](auto& network) {
+        trainTime = timeFunction([&network, &trainingSet, &weightsFile, loadWeights]() {
+            // If the load weights flag is passed and if the network is able to
+            // load from the file, then we can skip training.
+            if (loadWeights && network.loadWeightsFromFile(weightsFile)) return;
+            network.train(trainingSet);
+        });
 
-    // To save weights for later use, we can dump them to a file if the dump
-    // weights flag is passed.
-    if (dumpWeights) network.dumpWeightsToFile(weightsFile);
+        // To save weights for later use, we can dump them to a file if the dump
+        // weights flag is passed.
+        if (dumpWeights) network.dumpWeightsToFile(weightsFile);
 
-    size_t matches;
-    auto matchTime = timeFunction([&matches, &network, &trainingSet, verbose] {
-        matches = countCorrectPredictions(network, trainingSet, verbose);
-    });
+        matchTime = timeFunction([&matches, &network, &trainingSet, verbose] {
+            matches = countCorrectPredictions<batchSize>(network, trainingSet, verbose);
+        });
+        stats = network.trainingStats();
+    };
+
+    if (softmax) {
+        using Activation::Sigmoid;
+        using Activation::Softmax;
+        NeuralNetwork::NeuralNetwork<inputSize, hiddenSize, outputSize, Sigmoid, Softmax> network{
+            softmaxLearningRate, verbose, accuracy, Math::pixelOffset
+        };
+        run(network);
+    } else {
+        NeuralNetwork::NeuralNetwork<inputSize, hiddenSize, outputSize> network{
+            learningRate, verbose, accuracy, Math::pixelOffset
+        };
+        run(network);
+    }
 
     auto trainingSetSize = trainingSet.size();
     std::cout << "Neural Network Stats:" << std::endl;
@@ -202,6 +283,32 @@ int main(const int argc, const char* argv[]) {
     );
     std::cout << "  Parsing time: " << parseTime.count() << "ms" << std::endl
               << "  Training time: " << trainTime.count() << "ms" << std::endl
-              << "  Matching time: " << matchTime.count() << "ms" << std::endl;
+              << "  Matching time: " << matchTime.count() << "ms" << std::endl
+              << "  Threads: " << Threads::pool().size() << std::endl
+              << "  Kernels: " << Dispatch::isa() << ", " << Dispatch::products() << " products, "
+              << (approximate ? "approximate" : "exact") << " sigmoid, "
+              << (softmax ? "softmax" : "sigmoid") << " output" << std::endl;
+    std::printf(
+        "  Tuning: mc %zu, kc %zu, nc %zu, gemv rows %zu, parallel work %zu (%s)\n",
+        tuning.mc, tuning.kc, tuning.nc, tuning.gemvRows, tuning.parallelWork, tuningSource.c_str()
+    );
+
+    // Training statistics are only available if we actually trained.
+    if (stats.samples > 0) {
+        std::printf(
+            "  Training loss: %.6f\n  Gradient norms: %.6f input, %.6f hidden\n",
+            stats.loss, stats.inputGradientNorm, stats.hiddenGradientNorm
+        );
+    }
+
+    // The kernel is free to ignore our requests for huge pages, so we report
+    // how many we actually got next to how much memory asked for them.
+    const size_t mebibyte = 1024 * 1024;
+    auto hugePages = Allocator::hugePageUsage();
+    std::printf(
+        "  Huge pages: %ld MiB explicit, %ld MiB transparent (%ld MiB requested)\n",
+        hugePages.explicitBytes / mebibyte, hugePages.transparentBytes / mebibyte,
+        Allocator::hugePageBytesRequested().load() / mebibyte
+    );
 }
 
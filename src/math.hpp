@@ -1,18 +1,28 @@
 #pragma once
 #include <cmath>
+#include "kernels.hpp"
 #include "matrix.hpp"
 
 namespace Math {
+    /**
+     * The offset that shifts normalized pixels to the range [0.01, 1.0], so
+     * that no input of the network is ever 0. It isn't part of
+     * `normalizePixel()`, which keeps blank pixels at 0 and the inputs
+     * sparse. The network adds it back as a bias instead, see the
+     * `inputOffset` of `NeuralNetwork`.
+     */
+    constexpr double pixelOffset = 0.01;
+
     /**
      * Takes a pixel value in [0, 255] and "normalizes" it. This is done by dividing
-     * the pixel value by 255, multiplying it by 0.99 for scale, and then
-     * adding 0.01 to shift the range to [0.01, 1.0].
+     * the pixel value by 255 and multiplying it by 0.99 for scale, to the range
+     * [0, 0.99]. Adding `pixelOffset` shifts it to [0.01, 1.0].
      *
      * @param pixel The pixel value in range [0, 255].
-     * @return The pixel normalized to be in the range [0.01, 1.0].
+     * @return The pixel normalized to be in the range [0, 0.99].
      */
     inline double normalizePixel(const int pixel) {
-        return (static_cast<double>(pixel) / 255.0) * 0.99 + 0.01;
+        return (static_cast<double>(pixel) / 255.0) * 0.99;
     }
 
     /**
@@ -36,32 +46,46 @@ namespace Math {
      * @return The result of f(x) or f'(x).
      */
     inline double sigmoid(const double x, const bool derivative = false) {
-        if (derivative) return sigmoid(x) * (1 - sigmoid(x));
-        return 1.0 / (1.0 + std::exp(-x));
+        const double y = 1.0 / (1.0 + std::exp(-x));
+        return derivative ? y * (1 - y) : y;
     }
 
     /**
-     * Applies the sigmoid or sigmoid derivative to each value in a matrix of
-     * size `N * M`.
+     * Applies the sigmoid to each value in a matrix of size `N * M`, on the
+     * dispatched vector kernels, see `Kernels::sigmoid()`. Backpropagation
+     * gets the derivative from this output with `sigmoidDerivative()`, so
+     * the sigmoid is only ever computed once per value.
      *
      * @param matrix The matrix to apply sigmoid to.
-     * @param derivative If false, f(x). Else, f'(x). By default, this is false.
+     * @param accuracy Whether to use the exact or the approximate sigmoid,
+     * see `Kernels::fastSigmoid()`. By default, this is exact.
      * @return A new matrix with sigmoid applied to all entries.
      */
     template<size_t N, size_t M>
     Matrix::Matrix<double, N, M> sigmoid(
         const Matrix::Matrix<double, N, M>& matrix,
-        const bool derivative = false
+        const Kernels::Accuracy accuracy = Kernels::Accuracy::Exact
     ) {
-        Matrix::Matrix<double, N, M> result{};
-
-        for (size_t i = 0; i < N; ++i) {
-            for (size_t j = 0; j < M; ++j) {
-                result[i][j] = sigmoid(matrix[i][j], derivative);
-            }
-        }
-
+        Matrix::Matrix<double, N, M> result;
+        Kernels::sigmoid<double>(matrix.view(), result.view(), accuracy);
         return result;
     }
+
+    /**
+     * Calculates the derivative of the sigmoid from its output. If
+     * `y = f(x)`, then `f'(x) = y * (1 - y)`, which takes no `exp` at all.
+     *
+     * The result is an expression, so multiplying it into the errors is
+     * fused into a single vectorized pass, which runs on the dispatched
+     * `Kernels::sigmoidGradient()` if the errors are a matrix, too. It
+     * refers to `output`, which has to outlive it.
+     *
+     * @param output The output of `sigmoid()`.
+     * @return An expression for f'(x) at every entry.
+     */
+    template<size_t N, size_t M>
+    auto sigmoidDerivative(const Matrix::Matrix<double, N, M>& output) {
+        return output.map(Kernels::SigmoidDerivative{});
+    }
 } // Math
 
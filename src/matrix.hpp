@@ -1,11 +1,174 @@
 #pragma once
+#include <algorithm>
 #include <array>
+#include <cmath>
 #include <iomanip>
 #include <iostream>
 #include <random>
+#include <functional>
 #include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include "kernels.hpp"
+#include "layout.hpp"
+#include "storage.hpp"
+#include "unrolled.hpp"
+#include "view.hpp"
 
 namespace Matrix {
+    /**
+     * Empty tag shared by every matrix expression, used to tell expressions
+     * apart from scalars and other types in the operator overloads.
+     */
+    struct ExpressionTag {};
+
+    /**
+     * Base class for anything that can be used as a `N * M` matrix with
+     * entries of type `T`. This is the usual CRTP pattern: the derived class
+     * `E` provides `operator()(i, j)` to compute entry `(i, j)`, and the
+     * dimensions are carried in the type so that mismatched operands are still
+     * a compile time error.
+     *
+     * Element-wise operators don't compute anything themselves. They return a
+     * small expression object that remembers its operands, and the whole
+     * chain is evaluated in a single pass once it's assigned to a `Matrix`.
+     *
+     * @tparam E The derived expression type.
+     * @tparam T The entry type.
+     * @tparam N The number of rows.
+     * @tparam M The number of columns.
+     */
+    template<typename E, typename T, size_t N, size_t M>
+    struct Expression : ExpressionTag {
+        using Entry = T;
+        static constexpr size_t Rows = N;
+        static constexpr size_t Cols = M;
+
+        /**
+         * Whether the derived expression can also compute `Simd::Packet`s of
+         * consecutive entries in a row with `packet(i, j)`. Expressions that
+         * can are evaluated a register at a time.
+         */
+        static constexpr bool Vectorizable = false;
+
+        /**
+         * Casts this expression to its derived type.
+         *
+         * @return The derived expression.
+         */
+        const E& derived() const noexcept {
+            return static_cast<const E&>(*this);
+        }
+
+        constexpr size_t rows() const noexcept {
+            return N;
+        }
+
+        constexpr size_t cols() const noexcept {
+            return M;
+        }
+    };
+
+    /**
+     * True if `E` (after removing references and const) is a matrix
+     * expression.
+     *
+     * @tparam E The type to check.
+     */
+    template<typename E>
+    constexpr bool isExpression = std::is_base_of<ExpressionTag, std::decay_t<E>>::value;
+
+    /**
+     * How an expression stores one of its operands. Operands that are lvalues
+     * outlive the expression, so we only keep a reference to them. Temporaries
+     * would be destroyed at the end of the full expression, so those are moved
+     * into the expression instead, which makes it safe to store expressions
+     * in `auto` variables.
+     *
+     * @tparam E The forwarded operand type.
+     */
+    template<typename E>
+    using Operand = std::conditional_t<
+        std::is_lvalue_reference<E>::value,
+        const std::decay_t<E>&,
+        const std::decay_t<E>
+    >;
+
+    /**
+     * True if `F` can be called with packets of entries of type `T`, in which
+     * case an element-wise expression applying it can be vectorized.
+     *
+     * @tparam F The function type.
+     * @tparam T The entry type.
+     * @tparam Arguments The number of arguments `F` takes.
+     */
+    template<typename F, typename T, size_t Arguments>
+    constexpr bool isVectorizable = Arguments == 1
+        ? std::is_invocable<const F&, Simd::Packet<T>>::value
+        : std::is_invocable<const F&, Simd::Packet<T>, Simd::Packet<T>>::value;
+
+    template<typename T, size_t N, size_t M, typename S, typename L>
+    class TransposedMatrix;
+
+    /**
+     * The largest fraction of non-zero entries at which products with a
+     * sparse operand still beat the dense ones. Every non-zero entry costs
+     * an indexed load that can't be vectorized, so past this point sparse
+     * operands are expanded and multiplied by the dense kernels instead.
+     *
+     * The 300x784 input weights times a digit take a sparse dot product per
+     * row, which breaks even with the dense product at about 17% non-zero
+     * pixels with AVX-512, 21% with AVX2, and past 22% with SSE2. A
+     * column-major matrix reads whole columns for every non-zero entry and
+     * stays ahead for much denser vectors. This and `sparseUpdateDensity`
+     * are set for the widest vectors, which make the dense kernels fastest.
+     */
+    constexpr double sparseProductDensity = 0.17;
+
+    /**
+     * The largest fraction of non-zero entries of y at which the rank-1
+     * update `A += alpha * x * y^T` only touches the columns of A where y is
+     * non-zero, see `Matrix::ger()`. The dense update reads and writes all
+     * of A, so the sparse one stays ahead for denser vectors than the
+     * products do. For the input weights, it breaks even at about 25% with
+     * AVX-512 and AVX2, and is still a third faster at 22% with SSE2.
+     *
+     * MNIST digits have about 19% non-zero pixels, so with AVX-512 most of
+     * their products are dense and their updates sparse.
+     */
+    constexpr double sparseUpdateDensity = 0.25;
+
+    template<typename T, size_t N, size_t M, typename L>
+    class SparseMatrix;
+
+    template<typename E, typename F>
+    class UnaryExpression;
+
+    template<typename L, typename R, typename F>
+    class BinaryExpression;
+
+    template<typename L, typename R, typename F>
+    BinaryExpression<L, R, F> makeBinaryExpression(L&& left, R&& right, F function);
+
+    /**
+     * The element-wise kernel of `Kernels::Table` that evaluates expressions
+     * of type `E` into a matrix with layout `L`, if there is one. Other
+     * expressions are compiled into the code that assigns them, for the
+     * instruction set of that code, which is the baseline one if the kernels
+     * are dispatched. The forms found here run on the kernels picked at
+     * startup instead, see the specializations after `BinaryExpression`.
+     *
+     * Specializations set `exists` if the operands of the expression fit the
+     * kernel, and evaluate it into a view with `run()`.
+     *
+     * @tparam E The expression type.
+     * @tparam L The layout policy of the target matrix.
+     */
+    template<typename E, typename L>
+    struct TableKernel {
+        static constexpr bool exists = false;
+    };
+
     /**
      * Class representing a matrix of size `N * M` with entries of type `T`.
      * All of the matrix calculations are immutable and therefore create new
@@ -13,91 +176,1027 @@ namespace Matrix {
      *
      * For example, multiplying a `N * K` matrix by a `K * M` matrix will
      * result in a completely new matrix of size `N * M`, with the original
-     * matrices being left untouched.
+     * matrices being left untouched. Element-wise calculations are lazy and
+     * produce an `Expression` instead, which is computed in one pass when it
+     * is assigned to, or used to construct, a matrix.
+     *
+     * The only exceptions are the compound assignment operators and the BLAS
+     * style `axpy()`, `scale()` and `fill()`, which write into the existing
+     * storage of the matrix instead of creating a new one.
+     *
+     * Where the entries live is decided by the storage policy `S`. By default
+     * small matrices are stored inline and large ones on the heap, see
+     * `Storage::Automatic`. The order they are stored in is decided by the
+     * layout policy `L`, which is row-major by default, see `Layout`.
+     *
+     * @tparam T The Matrix entry type.
+     * @tparam N The number of rows.
+     * @tparam M The number of columns.
+     * @tparam S The storage policy.
+     * @tparam L The layout policy.
+     */
+    template<typename T, size_t N, size_t M, typename S = Storage::Automatic, typename L = Layout::RowMajor>
+    class Matrix : public Expression<Matrix<T, N, M, S, L>, T, N, M> {
+        using Buffer = typename S::template Buffer<T, L::storedRows(N, M), L::storedCols(N, M)>;
+
+    public:
+        /**
+         * The distance between the starts of two consecutive stored rows in
+         * `data()`, which are the columns of a column-major matrix. It's the
+         * length of a stored row unless the storage policy pads the rows.
+         */
+        static constexpr size_t Stride = Buffer::stride;
+
+        /**
+         * How the kernels read `view()` to get this matrix.
+         */
+        static constexpr Kernels::Operation ViewOperation = L::operation;
+
+        /**
+         * Row-major matrices load packets straight from their rows. The rows
+         * of column-major matrices aren't contiguous, so those are read one
+         * entry at a time.
+         */
+        static constexpr bool Vectorizable = Layout::isRowMajor<L>;
+
+        Matrix() = default;
+
+        /**
+         * Constructs a matrix by evaluating an expression of the same size.
+         *
+         * @tparam E The expression type.
+         * @param expression The expression to evaluate.
+         */
+        template<typename E>
+        Matrix(const Expression<E, T, N, M>& expression) {
+            assign(expression.derived());
+        }
+
+        /**
+         * Evaluates an expression of the same size into this matrix. Every
+         * entry is computed exactly once, in place, without any intermediate
+         * matrices. Since entry `(i, j)` of an element-wise expression only
+         * depends on entry `(i, j)` of its operands, the expression may refer
+         * to this matrix, like `w = w - rate * d`. The exception is the
+         * transpose of this matrix, like in `a = a.transpose() + b`, whose
+         * entry `(i, j)` is entry `(j, i)` of this matrix. Expressions that
+         * read it are evaluated into a temporary matrix first.
+         *
+         * @tparam E The expression type.
+         * @param expression The expression to evaluate.
+         * @return This matrix.
+         */
+        template<typename E>
+        Matrix& operator=(const Expression<E, T, N, M>& expression) {
+            assign(expression.derived());
+            return *this;
+        }
+
+        /**
+         * Adds an expression of the same size to this matrix in place.
+         *
+         * @tparam E The expression type.
+         * @param expression The expression to add.
+         * @return This matrix.
+         */
+        template<typename E>
+        Matrix& operator+=(const Expression<E, T, N, M>& expression) {
+            update(expression.derived(), std::plus<>{});
+            return *this;
+        }
+
+        /**
+         * Subtracts an expression of the same size from this matrix in place.
+         *
+         * @tparam E The expression type.
+         * @param expression The expression to subtract.
+         * @return This matrix.
+         */
+        template<typename E>
+        Matrix& operator-=(const Expression<E, T, N, M>& expression) {
+            update(expression.derived(), std::minus<>{});
+            return *this;
+        }
+
+        /**
+         * Multiplies every entry of this matrix by a scalar in place.
+         *
+         * @param scalar The scalar.
+         * @return This matrix.
+         */
+        Matrix& operator*=(const T scalar) {
+            return scale(scalar);
+        }
+
+        /**
+         * Adds `alpha * matrix` to this matrix in place. This is the BLAS
+         * `axpy` operation, and is the cheapest way to apply a gradient step
+         * to a matrix of weights. Matrices of another layout are added as
+         * expressions instead.
+         *
+         * @param alpha The scalar to multiply `matrix` by.
+         * @param matrix The matrix to add.
+         * @return This matrix.
+         */
+        template<typename S2>
+        Matrix& axpy(const T alpha, const Matrix<T, N, M, S2, L>& matrix) {
+            Kernels::axpy(alpha, matrix.view(), view());
+            return *this;
+        }
+
+        /**
+         * Adds `alpha * expression` to this matrix in place, evaluating the
+         * expression along the way.
+         *
+         * @tparam E The expression type.
+         * @param alpha The scalar to multiply `expression` by.
+         * @param expression The expression to add.
+         * @return This matrix.
+         */
+        template<typename E>
+        Matrix& axpy(const T alpha, const Expression<E, T, N, M>& expression) {
+            update(expression.derived(), [alpha](const auto& entry, const auto& other) { return entry + alpha * other; });
+            return *this;
+        }
+
+        /**
+         * Applies a function to every entry of this matrix. Like the other
+         * element-wise operations, this is lazy and returns an expression, so
+         * a chain of `map()`s and `zip()`s is fused into one pass.
+         *
+         * If the function can be called with a `Simd::Packet<T>` as well as a
+         * `T`, for example a generic lambda using only arithmetic operators,
+         * the pass runs a whole register at a time. Functions that only take
+         * a `T` are applied one entry at a time. Generic lambdas are always
+         * tried with packets, so one that calls scalar functions like
+         * `std::exp` has to take a `T` explicitly.
+         *
+         * @tparam F The function type.
+         * @param function The function to apply.
+         * @return The expression applying `function` to every entry.
+         */
+        template<typename F>
+        auto map(F function) const & {
+            return UnaryExpression<const Matrix&, F>{*this, function};
+        }
+
+        /**
+         * Applies a function to every entry of a temporary matrix, which is
+         * moved into the expression.
+         *
+         * @tparam F The function type.
+         * @param function The function to apply.
+         * @return The expression applying `function` to every entry.
+         */
+        template<typename F>
+        auto map(F function) && {
+            return UnaryExpression<Matrix, F>{std::move(*this), function};
+        }
+
+        /**
+         * Combines every entry of this matrix with the corresponding entry of
+         * an expression of the same size. See `map()`.
+         *
+         * @tparam R The forwarded expression type.
+         * @tparam F The function type.
+         * @param expression The expression to combine with.
+         * @param function Function taking an entry of this matrix and one of `expression`.
+         * @return The expression combining both.
+         */
+        template<typename R, typename F>
+        auto zip(R&& expression, F function) const & {
+            return makeBinaryExpression(*this, std::forward<R>(expression), function);
+        }
+
+        /**
+         * Combines every entry of a temporary matrix with the corresponding
+         * entry of an expression of the same size. See `map()`.
+         *
+         * @tparam R The forwarded expression type.
+         * @tparam F The function type.
+         * @param expression The expression to combine with.
+         * @param function Function taking an entry of this matrix and one of `expression`.
+         * @return The expression combining both.
+         */
+        template<typename R, typename F>
+        auto zip(R&& expression, F function) && {
+            return makeBinaryExpression(std::move(*this), std::forward<R>(expression), function);
+        }
+
+        /**
+         * Adds the outer product `alpha * x * y^T` to this matrix in place.
+         * This is the BLAS `ger` rank-1 update, which is what a gradient step
+         * for a layer of weights boils down to. Compared to computing the
+         * outer product and then adding it, the weights are only read and
+         * written once, and no temporary matrix is created.
+         *
+         * Columns that aren't plain matrices, like expressions or columns
+         * with another storage policy, are evaluated into one first.
+         *
+         * @tparam E1 The expression type of x.
+         * @tparam E2 The expression type of y.
+         * @param alpha The scalar to multiply the outer product by.
+         * @param x The `N * 1` column.
+         * @param y The `M * 1` column.
+         * @return This matrix.
+         */
+        template<typename E1, typename E2>
+        Matrix& ger(const T alpha, const Expression<E1, T, N, 1>& x, const Expression<E2, T, M, 1>& y) {
+            const Matrix<T, N, 1>& column1 = x.derived();
+            const Matrix<T, M, 1>& column2 = y.derived();
+
+            // The stored matrix of a column-major matrix is its transpose,
+            // which gets the transposed update `alpha * y * x^T`.
+            if constexpr (!Layout::isRowMajor<L>) Kernels::ger(alpha, column2.view(), column1.view(), view());
+            else if constexpr (Unrolled::fits<N, 1, M>) Unrolled::ger<T, N, M, Stride>(alpha, column1.data(), column2.data(), data());
+            else Kernels::ger(alpha, column1.view(), column2.view(), view());
+            return *this;
+        }
+
+        /**
+         * Adds the outer product `alpha * x * y^T` to this matrix in place,
+         * for a sparse y like a mostly blank input. Only the columns where y
+         * is non-zero are touched. If y is denser than `sparseUpdateDensity`,
+         * the dense update above is used instead.
+         *
+         * @tparam E The expression type of x.
+         * @param alpha The scalar to multiply the outer product by.
+         * @param x The `N * 1` column.
+         * @param y The sparse `M * 1` column, see `SparseVector`.
+         * @return This matrix.
+         */
+        template<typename E>
+        Matrix& ger(const T alpha, const Expression<E, T, N, 1>& x, const SparseMatrix<T, M, 1, Layout::ColumnMajor>& y) {
+            if (!y.isSparse(sparseUpdateDensity)) return ger(alpha, x, y.toMatrix());
+
+            const Matrix<T, N, 1>& column = x.derived();
+            Kernels::ger(ViewOperation, alpha, column.view(), y.view(), view());
+            return *this;
+        }
+
+        /**
+         * Multiplies every entry of this matrix by a scalar in place.
+         *
+         * @param alpha The scalar.
+         * @return This matrix.
+         */
+        Matrix& scale(const T alpha) {
+            Kernels::scale(alpha, view());
+            return *this;
+        }
+
+        /**
+         * Sets every entry of this matrix to the same value.
+         *
+         * @param value The value.
+         * @return This matrix.
+         */
+        Matrix& fill(const T value) {
+            // Padded rows are filled one by one, so the padding stays zero.
+            Kernels::fill(value, view());
+            return *this;
+        }
+
+        /**
+         * Adds up every entry of the matrix.
+         *
+         * @return The sum of the entries.
+         */
+        T sum() const {
+            return Kernels::sum<T>(view());
+        }
+
+        /**
+         * Computes the dot product with another matrix of the same size and
+         * layout, the sum of the products of the corresponding entries.
+         *
+         * @tparam S2 The storage policy of the other matrix.
+         * @param matrix The other matrix.
+         * @return The dot product.
+         */
+        template<typename S2>
+        T dot(const Matrix<T, N, M, S2, L>& matrix) const {
+            return Kernels::dot<T>(view(), matrix.view());
+        }
+
+        /**
+         * Computes the squared L2 (Frobenius) norm, the sum of the squares of
+         * the entries. Cheaper than `norm()`, and enough to compare norms or
+         * to compute a squared error loss.
+         *
+         * @return The squared norm.
+         */
+        T squaredNorm() const {
+            return Kernels::dot<T>(view(), view());
+        }
+
+        /**
+         * Computes the L2 (Frobenius) norm.
+         *
+         * @return The norm.
+         */
+        T norm() const {
+            return std::sqrt(squaredNorm());
+        }
+
+        /**
+         * Gets the largest entry of the matrix.
+         *
+         * @return The largest entry.
+         */
+        T max() const {
+            const size_t index = argmax();
+            return (*this)(index / M, index % M);
+        }
+
+        /**
+         * Finds the largest entry of the matrix. Entries are counted row by
+         * row, so for a column vector this is the row of the largest entry.
+         * Ties are broken in storage order, so a column-major matrix finds
+         * the first occurrence column by column.
+         *
+         * @return The index `i * M + j` of the first occurrence of the largest entry.
+         */
+        size_t argmax() const {
+            return logicalIndex(Kernels::argmax<T>(view()));
+        }
+
+        /**
+         * Finds the `K` largest entries of the matrix, counted row by row like
+         * in `argmax()`.
+         *
+         * @tparam K The number of entries to find.
+         * @return The indices of the entries, from the largest to the smallest.
+         */
+        template<size_t K>
+        std::array<size_t, K> topK() const {
+            static_assert(K <= N * M, "Can't find more entries than there are in the matrix!");
+            std::array<size_t, K> indices;
+            Kernels::topK<T>(view(), K, indices.data());
+            for (size_t& index : indices) index = logicalIndex(index);
+            return indices;
+        }
+
+        /**
+         * Gets the row of the matrix located at index `idx`. The row is
+         * returned as a pointer to its first entry, so `matrix[i][j]` is the
+         * entry at `(i, j)`. Only row-major matrices have contiguous rows.
+         *
+         * @param idx The index of the row.
+         * @throws std::out_of_range
+         * @return The `idx`-th row.
+         */
+        T* operator[](const size_t idx) {
+            static_assert(Layout::isRowMajor<L>, "Only row-major matrices have contiguous rows!");
+            if (idx >= N) throw std::out_of_range{"`idx` is out of range!"};
+            return _matrix.data() + idx * Stride;
+        }
+
+        /**
+         * Gets a constant pointer to the row of the matrix.
+         *
+         * @param idx The index of the row.
+         * @throws std::out_of_range
+         * @return The `idx`-th row.
+         */
+        const T* operator[](const size_t idx) const {
+            static_assert(Layout::isRowMajor<L>, "Only row-major matrices have contiguous rows!");
+            if (idx >= N) throw std::out_of_range{"`idx` is out of range!"};
+            return _matrix.data() + idx * Stride;
+        }
+
+        /**
+         * Transposes the current matrix. That is, for every entry `(i, j)`, we
+         * swap it with its corresponding entry, `(j, i)`.
+         *
+         * Nothing is copied: the result refers to this matrix and reads it
+         * with the indices swapped. Multiplying by it goes straight to the
+         * kernels, which read the original entries in transposed order.
+         *
+         * @return The transpose of this matrix.
+         */
+        TransposedMatrix<T, N, M, S, L> transpose() const & noexcept {
+            return TransposedMatrix<T, N, M, S, L>{*this};
+        }
+
+        /**
+         * Transposes a temporary matrix. A view would outlive the temporary,
+         * so the transpose is copied into a new matrix instead.
+         *
+         * @return The transpose of this matrix.
+         */
+        Matrix<T, M, N> transpose() const && {
+            return Matrix<T, M, N>{TransposedMatrix<T, N, M, S, L>{*this}};
+        }
+
+        /**
+         * Transposes this square matrix in place, without allocating a new
+         * one. Large matrices are split across several threads.
+         *
+         * @param threads The number of threads, or 0 to decide based on the size.
+         * @return This matrix.
+         */
+        Matrix& transposeInPlace(const size_t threads = 0) {
+            static_assert(N == M, "Only square matrices can be transposed in place!");
+            Kernels::transposeInPlace(view(), threads);
+            return *this;
+        }
+
+        /**
+         * Gets a pointer to the first entry of the matrix. The entries are
+         * stored contiguously in row-major order, so entry `(i, j)` is located
+         * at `data()[i * stride() + j]`, or at `data()[j * stride() + i]` for
+         * a column-major matrix. Depending on the storage policy, stored rows
+         * may be padded, so `stride()` can be larger than their length.
+         *
+         * @return Pointer to the entry at `(0, 0)`.
+         */
+        T* data() noexcept {
+            return _matrix.data();
+        }
+
+        /**
+         * Gets a constant pointer to the first entry of the matrix.
+         *
+         * @return Pointer to the entry at `(0, 0)`.
+         */
+        const T* data() const noexcept {
+            return _matrix.data();
+        }
+
+        /**
+         * Gets the entry at `(i, j)` without any bounds checking. This is what
+         * expressions use to read their operands.
+         *
+         * @param i The row index.
+         * @param j The column index.
+         * @return The entry at `(i, j)`.
+         */
+        const T& operator()(const size_t i, const size_t j) const noexcept {
+            return _matrix.data()[L::index(i, j, Stride)];
+        }
+
+        /**
+         * Gets a mutable reference to the entry at `(i, j)` without any bounds
+         * checking. Prefer this over `operator[]` in loops whose bounds are
+         * already known to be valid.
+         *
+         * @param i The row index.
+         * @param j The column index.
+         * @return The entry at `(i, j)`.
+         */
+        T& operator()(const size_t i, const size_t j) noexcept {
+            return _matrix.data()[L::index(i, j, Stride)];
+        }
+
+        /**
+         * Loads the packet of entries starting at `(i, j)` without any bounds
+         * checking. There must be a whole packet of entries left in the row.
+         * Only row-major matrices are `Vectorizable`.
+         *
+         * @param i The row index.
+         * @param j The column index of the first entry.
+         * @return The packet of entries.
+         */
+        Simd::Packet<T> packet(const size_t i, const size_t j) const noexcept {
+            static_assert(Layout::isRowMajor<L>, "Only row-major matrices have contiguous rows!");
+            return Simd::Packet<T>::load(_matrix.data() + i * Stride + j);
+        }
+
+        /**
+         * Gets a view of the whole matrix, which can be sliced further into
+         * rows, columns and blocks without copying. Views are row-major, so
+         * this is a view of the stored matrix: the `N * M` matrix itself, or
+         * its `M * N` transpose if it's column-major. The kernels read it
+         * with `ViewOperation`.
+         *
+         * @return The view of this matrix.
+         */
+        MatrixView<T> view() noexcept {
+            return {data(), L::storedRows(N, M), L::storedCols(N, M), Stride};
+        }
+
+        /**
+         * Gets a read-only view of the whole matrix, see above.
+         *
+         * @return The view of this matrix.
+         */
+        ConstMatrixView<T> view() const noexcept {
+            return {data(), L::storedRows(N, M), L::storedCols(N, M), Stride};
+        }
+
+        /**
+         * Gets the distance between the starts of two consecutive stored
+         * rows in `data()`.
+         *
+         * @return The row stride.
+         */
+        constexpr size_t stride() const noexcept {
+            return Stride;
+        }
+
+        /**
+         * Swaps the entries of two matrices. For heap allocated matrices this
+         * only swaps pointers.
+         *
+         * @param other The matrix to swap with.
+         */
+        void swap(Matrix& other) noexcept {
+            _matrix.swap(other._matrix);
+        }
+
+    private:
+        // The entries are stored in one flat buffer, rather than an array of
+        // rows, so that the kernels can treat the whole matrix as one
+        // contiguous block of memory.
+        Buffer _matrix;
+
+        /**
+         * Writes every entry of an expression into this matrix. A
+         * column-major matrix is written column by column, so that its
+         * stores stay contiguous. If the kernels are dispatched, expressions
+         * with a kernel of their own run on it, see `TableKernel`.
+         * Expressions that read the transpose of this matrix are evaluated
+         * into a temporary matrix first, see `readsTranspose()`.
+         *
+         * @tparam E The expression type.
+         * @param expression The expression to evaluate.
+         */
+        template<typename E>
+        void assign(const E& expression) {
+            if (readsTranspose(expression, data())) {
+                assign(Matrix{expression});
+                return;
+            }
+
+            if constexpr (Kernels::isDispatched<T> && TableKernel<E, L>::exists) {
+                TableKernel<E, L>::run(expression, view());
+            } else if constexpr (!Layout::isRowMajor<L>) {
+                for (size_t j = 0; j < M; ++j) {
+                    T* column = data() + j * Stride;
+                    for (size_t i = 0; i < N; ++i) column[i] = expression(i, j);
+                }
+            } else {
+                constexpr size_t W = Simd::Packet<T>::width;
+                constexpr size_t vectorized = E::Vectorizable ? M - M % W : 0;
+
+                for (size_t i = 0; i < N; ++i) {
+                    T* row = data() + i * Stride;
+                    if constexpr (E::Vectorizable) {
+                        for (size_t j = 0; j < vectorized; j += W) expression.packet(i, j).store(row + j);
+                    }
+                    for (size_t j = vectorized; j < M; ++j) row[j] = expression(i, j);
+                }
+            }
+        }
+
+        /**
+         * Copies a matrix of any storage and layout into this matrix. If the
+         * layouts differ, the stored matrix is transposed with the tiled
+         * kernel, which avoids a cache miss per entry.
+         *
+         * @tparam S2 The storage policy of the matrix.
+         * @tparam L2 The layout policy of the matrix.
+         * @param matrix The matrix to copy.
+         */
+        template<typename S2, typename L2>
+        void assign(const Matrix<T, N, M, S2, L2>& matrix) {
+            copy(matrix.view(), Matrix<T, N, M, S2, L2>::ViewOperation);
+        }
+
+        /**
+         * Writes a transpose into this matrix with the tiled kernel. Assigning
+         * the transpose of a matrix to itself transposes it in place.
+         *
+         * @tparam S2 The storage policy of the transposed matrix.
+         * @tparam L2 The layout policy of the transposed matrix.
+         * @param transposed The transposed matrix.
+         */
+        template<typename S2, typename L2>
+        void assign(const TransposedMatrix<T, M, N, S2, L2>& transposed) {
+            copy(transposed.view(), TransposedMatrix<T, M, N, S2, L2>::ViewOperation);
+        }
+
+        /**
+         * Copies a stored matrix that the kernels read with `op` into this
+         * matrix, see `view()`.
+         *
+         * @param source The view of the stored matrix.
+         * @param op How to read the stored matrix.
+         */
+        void copy(const ConstMatrixView<T> source, const Kernels::Operation op) {
+            const MatrixView<T> target = view();
+            if (op != ViewOperation) {
+                if (source.data() == data()) Kernels::transposeInPlace(target);
+                else Kernels::transpose(source, target);
+            } else if (source.data() != data()) {
+                for (size_t i = 0; i < target.rows(); ++i) std::copy(source.row(i), source.row(i) + target.cols(), target.row(i));
+            }
+        }
+
+        /**
+         * Combines every entry of this matrix with the corresponding entry of
+         * an expression, and stores the result in place. Like `assign()`,
+         * expressions that read the transpose of this matrix are evaluated
+         * into a temporary matrix first.
+         *
+         * @tparam E The expression type.
+         * @tparam F The function type.
+         * @param expression The expression to evaluate.
+         * @param function Function taking the current entry and the expression entry.
+         */
+        template<typename E, typename F>
+        void update(const E& expression, F function) {
+            if (readsTranspose(expression, data())) {
+                update(Matrix{expression}, function);
+                return;
+            }
+
+            if constexpr (!Layout::isRowMajor<L>) {
+                for (size_t j = 0; j < M; ++j) {
+                    T* column = data() + j * Stride;
+                    for (size_t i = 0; i < N; ++i) column[i] = function(column[i], expression(i, j));
+                }
+            } else {
+                constexpr bool vectorizable = E::Vectorizable && isVectorizable<F, T, 2>;
+                constexpr size_t W = Simd::Packet<T>::width;
+                constexpr size_t vectorized = vectorizable ? M - M % W : 0;
+
+                for (size_t i = 0; i < N; ++i) {
+                    T* row = data() + i * Stride;
+                    if constexpr (vectorizable) {
+                        for (size_t j = 0; j < vectorized; j += W) {
+                            function(Simd::Packet<T>::load(row + j), expression.packet(i, j)).store(row + j);
+                        }
+                    }
+                    for (size_t j = vectorized; j < M; ++j) row[j] = function(row[j], expression(i, j));
+                }
+            }
+        }
+
+        /**
+         * Converts an index into the stored matrix, as found by the kernels,
+         * into the index `i * M + j` of the same entry.
+         *
+         * @param index The index into the stored matrix.
+         * @return The index into this matrix.
+         */
+        static constexpr size_t logicalIndex(const size_t index) {
+            return Layout::isRowMajor<L> ? index : index % N * M + index / N;
+        }
+    };
+
+    /**
+     * Swaps the entries of two matrices of the same type.
      *
      * @tparam T The Matrix entry type.
      * @tparam N The number of rows.
      * @tparam M The number of columns.
+     * @tparam S The storage policy.
+     * @tparam L The layout policy.
+     * @param matrix1 The first matrix.
+     * @param matrix2 The second matrix.
+     */
+    template<typename T, size_t N, size_t M, typename S, typename L>
+    void swap(Matrix<T, N, M, S, L>& matrix1, Matrix<T, N, M, S, L>& matrix2) noexcept {
+        matrix1.swap(matrix2);
+    }
+
+    /**
+     * Zero-copy transpose of a `N * M` matrix, which is itself a `M * N`
+     * expression. It only holds a reference to the matrix, so it must not
+     * outlive it.
+     *
+     * Like any expression it can be assigned to a matrix, which copies it
+     * with the tiled transpose kernel. Assigning it back to the matrix it
+     * refers to transposes that matrix in place.
+     *
+     * @tparam T The Matrix entry type.
+     * @tparam N The number of rows of the original matrix.
+     * @tparam M The number of columns of the original matrix.
+     * @tparam S The storage policy of the original matrix.
+     * @tparam L The layout policy of the original matrix.
      */
-    template<typename T, size_t N, size_t M>
-    class Matrix {
+    template<typename T, size_t N, size_t M, typename S, typename L>
+    class TransposedMatrix : public Expression<TransposedMatrix<T, N, M, S, L>, T, M, N> {
     public:
         /**
-         * Gets the row of the matrix located at index `idx`.
+         * How the kernels read `view()` to get the transpose, which is the
+         * opposite of how they read it to get the original matrix.
+         */
+        static constexpr Kernels::Operation ViewOperation = Kernels::opposite(L::operation);
+
+        explicit TransposedMatrix(const Matrix<T, N, M, S, L>& matrix) noexcept : _matrix{matrix} {
+        }
+
+        const T& operator()(const size_t i, const size_t j) const noexcept {
+            return _matrix(j, i);
+        }
+
+        /**
+         * Transposes the transpose, which is just the original matrix.
          *
-         * @param idx The index of the row.
-         * @throws std::out_of_range
-         * @return The `idx`-th row.
+         * @return The original matrix.
          */
-        std::array<T, M>& operator[](const size_t idx) {
-            if (idx >= N) throw std::out_of_range{"`idx` is out of range!"};
-            return _matrix[idx];
+        const Matrix<T, N, M, S, L>& transpose() const noexcept {
+            return _matrix;
         }
 
         /**
-         * Gets a constant reference to the row of the matrix.
+         * Copies the transpose into a new matrix, splitting the work across
+         * `threads` threads. Converting to a matrix does the same, but picks
+         * the number of threads by itself.
          *
-         * @param idx The index of the row.
-         * @throws std::out_of_range
-         * @return The `idx`-th row.
+         * @param threads The number of threads, or 0 to decide based on the size.
+         * @return A new matrix holding the transpose.
          */
-        const std::array<T, M>& operator[](const size_t idx) const {
-            if (idx >= N) throw std::out_of_range{"`idx` is out of range!"};
-            return _matrix[idx];
+        Matrix<T, M, N> materialize(const size_t threads = 0) const {
+            Matrix<T, M, N> result;
+            if constexpr (Layout::isRowMajor<L>) Kernels::transpose(view(), result.view(), threads);
+            else result = *this;
+            return result;
         }
 
         /**
-         * Transposes the current matrix. That is, for every entry `(i, j)`, we
-         * swap it with its corresponding entry, `(j, i)`.
+         * Gets a view of the original, untransposed matrix, which is what the
+         * kernels are given along with `ViewOperation`.
          *
-         * @return The transpose of this matrix.
+         * @return The view of the original matrix.
          */
-        Matrix<T, M, N> transpose() const {
-            Matrix<T, M, N> result{};
+        ConstMatrixView<T> view() const noexcept {
+            return _matrix.view();
+        }
 
-            for (size_t i = 0; i < N; ++i) {
-                for (size_t j = 0; j < M; ++j) {
-                    result[j][i] = _matrix[i][j];
-                }
-            }
+    private:
+        const Matrix<T, N, M, S, L>& _matrix;
+    };
 
-            return result;
+    /**
+     * Expression applying a function to every entry of another expression.
+     *
+     * @tparam E The forwarded operand type.
+     * @tparam F The function type.
+     */
+    template<typename E, typename F>
+    class UnaryExpression : public Expression<
+        UnaryExpression<E, F>,
+        typename std::decay_t<E>::Entry,
+        std::decay_t<E>::Rows,
+        std::decay_t<E>::Cols
+    > {
+        using T = typename std::decay_t<E>::Entry;
+
+    public:
+        static constexpr bool Vectorizable = std::decay_t<E>::Vectorizable && isVectorizable<F, T, 1>;
+
+        UnaryExpression(E&& operand, F function) :
+            _operand{std::forward<E>(operand)},
+            _function{function} {
         }
 
-        constexpr size_t rows() const noexcept {
-            return N;
+        T operator()(const size_t i, const size_t j) const {
+            return _function(_operand(i, j));
         }
 
-        constexpr size_t cols() const noexcept {
-            return M;
+        Simd::Packet<T> packet(const size_t i, const size_t j) const {
+            return _function(_operand.packet(i, j));
+        }
+
+        const std::decay_t<E>& operand() const noexcept {
+            return _operand;
         }
 
     private:
-        std::array<std::array<T, M>, N> _matrix;
+        Operand<E> _operand;
+        F _function;
     };
 
     /**
-     * Subtracts a `matrix1` by `matrix2`. The two matrices must have the same
+     * Expression combining the entries of two expressions of the same size
+     * with a function.
+     *
+     * @tparam L The forwarded left operand type.
+     * @tparam R The forwarded right operand type.
+     * @tparam F The function type.
+     */
+    template<typename L, typename R, typename F>
+    class BinaryExpression : public Expression<
+        BinaryExpression<L, R, F>,
+        typename std::decay_t<L>::Entry,
+        std::decay_t<L>::Rows,
+        std::decay_t<L>::Cols
+    > {
+        using T = typename std::decay_t<L>::Entry;
+
+    public:
+        static constexpr bool Vectorizable =
+            std::decay_t<L>::Vectorizable && std::decay_t<R>::Vectorizable && isVectorizable<F, T, 2>;
+
+        BinaryExpression(L&& left, R&& right, F function) :
+            _left{std::forward<L>(left)},
+            _right{std::forward<R>(right)},
+            _function{function} {
+        }
+
+        T operator()(const size_t i, const size_t j) const {
+            return _function(_left(i, j), _right(i, j));
+        }
+
+        Simd::Packet<T> packet(const size_t i, const size_t j) const {
+            return _function(_left.packet(i, j), _right.packet(i, j));
+        }
+
+        const std::decay_t<L>& left() const noexcept {
+            return _left;
+        }
+
+        const std::decay_t<R>& right() const noexcept {
+            return _right;
+        }
+
+    private:
+        Operand<L> _left;
+        Operand<R> _right;
+        F _function;
+    };
+
+    /**
+     * Builds an element-wise expression from two operands, making sure they
+     * have the same entry type and dimensions.
+     *
+     * @tparam L The forwarded left operand type.
+     * @tparam R The forwarded right operand type.
+     * @tparam F The function type.
+     * @param left The left operand.
+     * @param right The right operand.
+     * @param function The function combining two entries.
+     * @return The lazy expression.
+     */
+    template<typename L, typename R, typename F>
+    BinaryExpression<L, R, F> makeBinaryExpression(L&& left, R&& right, F function) {
+        using Left = std::decay_t<L>;
+        using Right = std::decay_t<R>;
+        static_assert(std::is_same<typename Left::Entry, typename Right::Entry>::value, "Entry types must match!");
+        static_assert(Left::Rows == Right::Rows && Left::Cols == Right::Cols, "Matrix dimensions must match!");
+
+        return {std::forward<L>(left), std::forward<R>(right), function};
+    }
+
+    /**
+     * Whether an expression reads the transpose of the matrix stored at
+     * `data`. Entry `(i, j)` of such an expression reads entry `(j, i)` of
+     * that matrix, so it can't be evaluated into that matrix in place, see
+     * `Matrix::assign()`. Every other expression only reads the entries of
+     * its operands at its own position.
+     *
+     * @tparam E The expression type.
+     * @param data Pointer to the entries of the matrix.
+     * @return True if the expression reads the transpose of the matrix.
+     */
+    template<typename E, typename T, size_t N, size_t M>
+    bool readsTranspose(const Expression<E, T, N, M>&, const T*) noexcept {
+        return false;
+    }
+
+    template<typename T, size_t N, size_t M, typename S, typename L>
+    bool readsTranspose(const TransposedMatrix<T, N, M, S, L>& transposed, const T* data) noexcept {
+        return transposed.view().data() == data;
+    }
+
+    template<typename E, typename F, typename T>
+    bool readsTranspose(const UnaryExpression<E, F>& expression, const T* data) noexcept {
+        return readsTranspose(expression.operand(), data);
+    }
+
+    template<typename L, typename R, typename F, typename T>
+    bool readsTranspose(const BinaryExpression<L, R, F>& expression, const T* data) noexcept {
+        return readsTranspose(expression.left(), data) || readsTranspose(expression.right(), data);
+    }
+
+    /**
+     * True if `E` is a matrix stored in the layout `L`, whose view lines up
+     * entry for entry with the view of any other matrix of that layout.
+     *
+     * @tparam E The type to check.
+     * @tparam L The layout policy.
+     */
+    template<typename E, typename L>
+    constexpr bool isStoredAs = false;
+
+    template<typename T, size_t N, size_t M, typename S, typename L>
+    constexpr bool isStoredAs<Matrix<T, N, M, S, L>, L> = true;
+
+    /**
+     * `A + B`, `A - B` and `A ^ B` of two matrices, which run on
+     * `Kernels::Table::add`, `subtract` and `multiply`.
+     *
+     * @tparam A The forwarded left operand type.
+     * @tparam B The forwarded right operand type.
+     * @tparam F The function type.
+     * @tparam L The layout policy of the target matrix.
+     */
+    template<typename A, typename B, typename F, typename L>
+    struct TableKernel<BinaryExpression<A, B, F>, L> {
+        using T = typename std::decay_t<A>::Entry;
+
+        static constexpr bool exists = isStoredAs<std::decay_t<A>, L> && isStoredAs<std::decay_t<B>, L> && (
+            std::is_same<F, std::plus<>>::value || std::is_same<F, std::minus<>>::value || std::is_same<F, std::multiplies<>>::value
+        );
+
+        static void run(const BinaryExpression<A, B, F>& expression, const MatrixView<T> target) {
+            const auto& table = Kernels::kernels<T>();
+            const auto kernel = std::is_same<F, std::plus<>>::value ? table.add
+                : std::is_same<F, std::minus<>>::value ? table.subtract
+                : table.multiply;
+            Kernels::elementwise(expression.left().view(), expression.right().view(), target, kernel);
+        }
+    };
+
+    /**
+     * `E ^ map(Y, Kernels::SigmoidDerivative{})`, the gradient at the inputs
+     * of a sigmoid layer from its errors E and outputs Y, which runs on
+     * `Kernels::Table::sigmoidGradient`.
+     *
+     * @tparam A The forwarded type of the errors.
+     * @tparam B The forwarded type of the outputs.
+     * @tparam L The layout policy of the target matrix.
+     */
+    template<typename A, typename B, typename L>
+    struct TableKernel<BinaryExpression<A, UnaryExpression<B, Kernels::SigmoidDerivative>, std::multiplies<>>, L> {
+        using T = typename std::decay_t<A>::Entry;
+        using Gradient = BinaryExpression<A, UnaryExpression<B, Kernels::SigmoidDerivative>, std::multiplies<>>;
+
+        static constexpr bool exists = isStoredAs<std::decay_t<A>, L> && isStoredAs<std::decay_t<B>, L>;
+
+        static void run(const Gradient& expression, const MatrixView<T> target) {
+            const auto& outputs = expression.right().operand();
+            Kernels::elementwise(expression.left().view(), outputs.view(), target, Kernels::kernels<T>().sigmoidGradient);
+        }
+    };
+
+    /**
+     * Returns the matrix itself, since it doesn't need evaluating. Used by
+     * operations that need their operands to be stored in memory.
+     *
+     * @param matrix The matrix.
+     * @return The same matrix.
+     */
+    template<typename T, size_t N, size_t M, typename S, typename L>
+    const Matrix<T, N, M, S, L>& evaluate(const Matrix<T, N, M, S, L>& matrix) {
+        return matrix;
+    }
+
+    /**
+     * Returns the transpose itself. The product kernels read the original
+     * matrix in transposed order, so there's nothing to evaluate.
+     *
+     * @param matrix The transposed matrix.
+     * @return The same transposed matrix.
+     */
+    template<typename T, size_t N, size_t M, typename S, typename L>
+    const TransposedMatrix<T, N, M, S, L>& evaluate(const TransposedMatrix<T, N, M, S, L>& matrix) {
+        return matrix;
+    }
+
+    /**
+     * Evaluates an expression into a new matrix.
+     *
+     * @param expression The expression.
+     * @return A new matrix holding the result of the expression.
+     */
+    template<typename E, typename T, size_t N, size_t M>
+    Matrix<T, N, M> evaluate(const Expression<E, T, N, M>& expression) {
+        return Matrix<T, N, M>{expression};
+    }
+
+    /**
+     * Adds `matrix1` and `matrix2`. The two matrices must have the same
      * dimensions, otherwise there'd be a compile time error.
      *
-     * @tparam T The Matrix entry type.
-     * @tparam N The row count for the matrices.
-     * @tparam M The column count for the matrices.
+     * @tparam L The left expression type.
+     * @tparam R The right expression type.
      * @param matrix1 The first matrix.
      * @param matrix2 The second matrix.
-     * @return The result of `matrix1 - matrix2`.
+     * @return The expression for `matrix1 + matrix2`.
      */
-    template<typename T, size_t N, size_t M>
-    Matrix<T, N, M> operator-(const Matrix<T, N, M>& matrix1, const Matrix<T, N, M>& matrix2) {
-        Matrix<T, N, M> result{};
-
-        for (size_t i = 0; i < N; ++i) {
-            for (size_t j = 0; j < M; ++j) {
-                result[i][j] = matrix1[i][j] - matrix2[i][j];
-            }
-        }
+    template<typename L, typename R, typename = std::enable_if_t<isExpression<L> && isExpression<R>>>
+    auto operator+(L&& matrix1, R&& matrix2) {
+        return makeBinaryExpression(std::forward<L>(matrix1), std::forward<R>(matrix2), std::plus<>{});
+    }
 
-        return result;
+    /**
+     * Subtracts a `matrix1` by `matrix2`. The two matrices must have the same
+     * dimensions, otherwise there'd be a compile time error.
+     *
+     * @tparam L The left expression type.
+     * @tparam R The right expression type.
+     * @param matrix1 The first matrix.
+     * @param matrix2 The second matrix.
+     * @return The expression for `matrix1 - matrix2`.
+     */
+    template<typename L, typename R, typename = std::enable_if_t<isExpression<L> && isExpression<R>>>
+    auto operator-(L&& matrix1, R&& matrix2) {
+        return makeBinaryExpression(std::forward<L>(matrix1), std::forward<R>(matrix2), std::minus<>{});
     }
 
     /**
@@ -106,47 +1205,75 @@ namespace Matrix {
      * size `N * M`. Conventially, the Hadamard product is represented with an
      * empty circle, but in the context of C++, we'll use ^.
      *
-     * @tparam T The Matrix entry type.
-     * @tparam N The row count for the matrices.
-     * @tparam M The column count for the matrices.
+     * @tparam L The left expression type.
+     * @tparam R The right expression type.
      * @param matrix1 The first matrix.
      * @param matrix2 The second matrix.
-     * @return The Hadamard product of `matrix1` and `matrix2`.
+     * @return The expression for the Hadamard product of `matrix1` and `matrix2`.
      */
-    template<typename T, size_t N, size_t M>
-    Matrix<T, N, M> operator^(const Matrix<T, N, M>& matrix1, const Matrix<T, N, M>& matrix2) {
-        Matrix<T, N, M> result{};
-
-        for (size_t i = 0; i < N; ++i) {
-            for (size_t j = 0; j < M; ++j) {
-                result[i][j] = matrix1[i][j] * matrix2[i][j];
-            }
-        }
-
-        return result;
+    template<typename L, typename R, typename = std::enable_if_t<isExpression<L> && isExpression<R>>>
+    auto operator^(L&& matrix1, R&& matrix2) {
+        return makeBinaryExpression(std::forward<L>(matrix1), std::forward<R>(matrix2), std::multiplies<>{});
     }
 
     /**
      * Multiplies a scalar value of Matrix entry type `T` to each entry in the
      * matrix.
      *
-     * @tparam T The Matrix entry type.
-     * @tparam N The row count for the matrix.
-     * @tparam M The column count for the matrix.
+     * @tparam E The expression type.
      * @param scalar The scalar to multiply the each entry `(i, j)` by.
      * @param matrix The matrix.
-     * @return The result of `matrix1 - matrix2`.
+     * @return The expression for `scalar * matrix`.
      */
-    template<typename T, size_t N, size_t M>
-    Matrix<T, N, M> operator*(const T& scalar, const Matrix<T, N, M>& matrix) {
-        Matrix<T, N, M> result{};
+    template<typename E, typename = std::enable_if_t<isExpression<E>>>
+    auto operator*(const typename std::decay_t<E>::Entry scalar, E&& matrix) {
+        auto scale = [scalar](const auto& entry) { return entry * scalar; };
+        return UnaryExpression<E, decltype(scale)>{std::forward<E>(matrix), scale};
+    }
 
-        for (size_t i = 0; i < N; ++i) {
-            for (size_t j = 0; j < M; ++j) result[i][j] = matrix[i][j] * scalar;
+    /**
+     * Negates the matrix. Multiplies every entry by -1.
+     *
+     * @tparam E The expression type.
+     * @param matrix The matrix.
+     * @return The expression for the negated matrix.
+     */
+    template<typename E, typename = std::enable_if_t<isExpression<E>>>
+    auto operator-(E&& matrix) {
+        return UnaryExpression<E, std::negate<>>{std::forward<E>(matrix), std::negate<>{}};
+    }
 
-        }
+    /**
+     * Applies a function to every entry of an expression. This is the free
+     * function version of `Matrix::map()`, which also works on expressions,
+     * so that element-wise steps can be chained without evaluating them.
+     *
+     * @tparam E The expression type.
+     * @tparam F The function type.
+     * @param expression The expression.
+     * @param function The function to apply.
+     * @return The expression applying `function` to every entry.
+     */
+    template<typename E, typename F, typename = std::enable_if_t<isExpression<E>>>
+    auto map(E&& expression, F function) {
+        return UnaryExpression<E, F>{std::forward<E>(expression), function};
+    }
 
-        return result;
+    /**
+     * Combines the corresponding entries of two expressions of the same
+     * size. This is the free function version of `Matrix::zip()`.
+     *
+     * @tparam L The left expression type.
+     * @tparam R The right expression type.
+     * @tparam F The function type.
+     * @param left The left expression.
+     * @param right The right expression.
+     * @param function Function taking an entry of `left` and one of `right`.
+     * @return The expression combining both.
+     */
+    template<typename L, typename R, typename F, typename = std::enable_if_t<isExpression<L> && isExpression<R>>>
+    auto zip(L&& left, R&& right, F function) {
+        return makeBinaryExpression(std::forward<L>(left), std::forward<R>(right), function);
     }
 
     /**
@@ -154,43 +1281,192 @@ namespace Matrix {
      * be compatible in the sense that the columns this matrix must be equal to
      * the rows in the second matrix.
      *
+     * This and the products below are split into two tiers by their shape,
+     * which is known at compile time. Products for which `Unrolled::fits`
+     * use the fully unrolled kernels in `Unrolled`, everything else the
+     * blocked, possibly threaded, kernels in `Kernels`. The unrolled kernels
+     * only take row-major operands. Either layout is fine for the blocked
+     * ones, which read a column-major operand as the transpose of what it
+     * stores, see `Layout`.
+     *
      * @tparam T The Matrix entry type.
      * @tparam N The row count for the first matrix.
      * @tparam K The column count and row count for the first and second matrices, respectively.
      * @tparam M The column count for the second matrix.
+     * @tparam S1 The storage policy of the first matrix.
+     * @tparam S2 The storage policy of the second matrix.
+     * @tparam L1 The layout policy of the first matrix.
+     * @tparam L2 The layout policy of the second matrix.
      * @param matrix The matrix to multiply to.
      * @return A new matrix holding the matrix product.
      */
-    template<typename T, size_t N, size_t K, size_t M>
-    Matrix<T, N, M> operator*(const Matrix<T, N, K>& matrix1, const Matrix<T, K, M>& matrix2) {
+    template<typename T, size_t N, size_t K, size_t M, typename S1, typename S2, typename L1, typename L2>
+    Matrix<T, N, M> operator*(const Matrix<T, N, K, S1, L1>& matrix1, const Matrix<T, K, M, S2, L2>& matrix2) {
         Matrix<T, N, M> result{};
 
-        // Standard O(n^3) algorithm for finding the matrix product. Here, we
-        // iterate through the rows and columns of the matrix product.
-        for (size_t i = 0; i < N; ++i) {
-            for (size_t j = 0; j < M; ++j) {
-                // Here, we're traversing the i-th row of matrix1 and the j-th
-                // column of matrix2.  Since we're doing a dot product between
-                // the row and column, we're continually adding the product of
-                // the k-th element in the row and column.
-                for (size_t k = 0; k < K; ++k) result[i][j] += matrix1[i][k] * matrix2[k][j];
+        // Large products are computed by a cache-blocked kernel, which packs
+        // blocks of both matrices into contiguous buffers so that the inner
+        // loops never have to stride down the columns of `matrix2`.
+        if constexpr (Unrolled::fits<N, K, M> && Layout::isRowMajor<L1> && Layout::isRowMajor<L2>) {
+            Unrolled::gemm<T, N, K, M, Matrix<T, N, K, S1>::Stride, Matrix<T, K, M, S2>::Stride, Matrix<T, N, M>::Stride>(
+                matrix1.data(), matrix2.data(), result.data()
+            );
+        } else {
+            constexpr auto opA = Matrix<T, N, K, S1, L1>::ViewOperation;
+            constexpr auto opB = Matrix<T, K, M, S2, L2>::ViewOperation;
+            Kernels::gemm(opA, matrix1.view(), opB, matrix2.view(), result.view());
+        }
 
-            }
+        return result;
+    }
+
+    /**
+     * Multiplies a matrix by a column vector. This is the same product as
+     * above, but since the result is a single column, every entry is a dot
+     * product of a contiguous row of `matrix` with `vector`, and we use a
+     * dedicated vectorized kernel instead of the blocked one. A column-major
+     * matrix is multiplied column by column instead, like a transpose.
+     *
+     * @tparam T The Matrix entry type.
+     * @tparam N The row count for the matrix.
+     * @tparam K The column count for the matrix and the size of the vector.
+     * @tparam S1 The storage policy of the matrix.
+     * @tparam S2 The storage policy of the vector.
+     * @tparam L1 The layout policy of the matrix.
+     * @param matrix The matrix.
+     * @param vector The column vector to multiply by.
+     * @return A new column vector holding the product.
+     */
+    template<typename T, size_t N, size_t K, typename S1, typename S2, typename L1>
+    Matrix<T, N, 1> operator*(const Matrix<T, N, K, S1, L1>& matrix, const Matrix<T, K, 1, S2>& vector) {
+        Matrix<T, N, 1> result{};
+        if constexpr (Unrolled::fits<N, K, 1> && Layout::isRowMajor<L1>) {
+            Unrolled::gemv<T, N, K, Matrix<T, N, K, S1>::Stride>(matrix.data(), vector.data(), result.data());
+        } else {
+            Kernels::gemv(Matrix<T, N, K, S1, L1>::ViewOperation, matrix.view(), vector.view(), result.view());
         }
+        return result;
+    }
 
+    /**
+     * Computes `matrix1^T * matrix2` without transposing `matrix1`. The
+     * blocked kernel packs the columns of the original matrix instead of its
+     * rows, which costs the same as packing a transposed copy would.
+     *
+     * @tparam T The Matrix entry type.
+     * @tparam K The row count of the original first matrix and of the second matrix.
+     * @tparam N The column count of the original first matrix.
+     * @tparam M The column count for the second matrix.
+     * @tparam S1 The storage policy of the first matrix.
+     * @tparam S2 The storage policy of the second matrix.
+     * @tparam L1 The layout policy of the first matrix.
+     * @tparam L2 The layout policy of the second matrix.
+     * @param matrix1 The transposed first matrix.
+     * @param matrix2 The second matrix.
+     * @return A new matrix holding the matrix product.
+     */
+    template<typename T, size_t K, size_t N, size_t M, typename S1, typename S2, typename L1, typename L2>
+    Matrix<T, N, M> operator*(const TransposedMatrix<T, K, N, S1, L1>& matrix1, const Matrix<T, K, M, S2, L2>& matrix2) {
+        Matrix<T, N, M> result{};
+        constexpr auto opA = TransposedMatrix<T, K, N, S1, L1>::ViewOperation;
+        constexpr auto opB = Matrix<T, K, M, S2, L2>::ViewOperation;
+        Kernels::gemm(opA, matrix1.view(), opB, matrix2.view(), result.view());
         return result;
     }
 
     /**
-     * Negates the matrix. Multiplies every entry by -1.
+     * Computes `matrix^T * vector` without transposing `matrix`. Instead of
+     * a dot product per column, which would stride down the matrix, the rows
+     * of the matrix are scaled by the entries of the vector and added up.
      *
-     * @tparam N The number of rows.
-     * @tparam M The number of columns.
-     * @return A new matrix which is the original matrix but with all negated values.
+     * @tparam T The Matrix entry type.
+     * @tparam K The row count of the original matrix and the size of the vector.
+     * @tparam N The column count of the original matrix.
+     * @tparam S1 The storage policy of the matrix.
+     * @tparam S2 The storage policy of the vector.
+     * @tparam L1 The layout policy of the matrix.
+     * @param matrix The transposed matrix.
+     * @param vector The column vector to multiply by.
+     * @return A new column vector holding the product.
+     */
+    template<typename T, size_t K, size_t N, typename S1, typename S2, typename L1>
+    Matrix<T, N, 1> operator*(const TransposedMatrix<T, K, N, S1, L1>& matrix, const Matrix<T, K, 1, S2>& vector) {
+        Matrix<T, N, 1> result{};
+        if constexpr (Unrolled::fits<N, K, 1> && Layout::isRowMajor<L1>) {
+            Unrolled::gemvTransposed<T, K, N, Matrix<T, K, N, S1>::Stride>(matrix.view().data(), vector.data(), result.data());
+        } else {
+            Kernels::gemv(TransposedMatrix<T, K, N, S1, L1>::ViewOperation, matrix.view(), vector.view(), result.view());
+        }
+        return result;
+    }
+
+    /**
+     * Computes `matrix1 * matrix2^T` without transposing `matrix2`.
+     *
+     * @tparam T The Matrix entry type.
+     * @tparam N The row count for the first matrix.
+     * @tparam K The column count of the first matrix and of the original second matrix.
+     * @tparam M The row count of the original second matrix.
+     * @tparam S1 The storage policy of the first matrix.
+     * @tparam S2 The storage policy of the second matrix.
+     * @tparam L1 The layout policy of the first matrix.
+     * @tparam L2 The layout policy of the second matrix.
+     * @param matrix1 The first matrix.
+     * @param matrix2 The transposed second matrix.
+     * @return A new matrix holding the matrix product.
+     */
+    template<typename T, size_t N, size_t K, size_t M, typename S1, typename S2, typename L1, typename L2>
+    Matrix<T, N, M> operator*(const Matrix<T, N, K, S1, L1>& matrix1, const TransposedMatrix<T, M, K, S2, L2>& matrix2) {
+        Matrix<T, N, M> result{};
+        constexpr auto opA = Matrix<T, N, K, S1, L1>::ViewOperation;
+        constexpr auto opB = TransposedMatrix<T, M, K, S2, L2>::ViewOperation;
+        Kernels::gemm(opA, matrix1.view(), opB, matrix2.view(), result.view());
+        return result;
+    }
+
+    /**
+     * Computes `matrix1^T * matrix2^T` without transposing either matrix.
+     *
+     * @tparam T The Matrix entry type.
+     * @tparam K The row count of the original first matrix.
+     * @tparam N The column count of the original first matrix and the row count of the original second matrix.
+     * @tparam M The row count of the original second matrix.
+     * @tparam S1 The storage policy of the first matrix.
+     * @tparam S2 The storage policy of the second matrix.
+     * @tparam L1 The layout policy of the first matrix.
+     * @tparam L2 The layout policy of the second matrix.
+     * @param matrix1 The transposed first matrix.
+     * @param matrix2 The transposed second matrix.
+     * @return A new matrix holding the matrix product.
+     */
+    template<typename T, size_t K, size_t N, size_t M, typename S1, typename S2, typename L1, typename L2>
+    Matrix<T, K, M> operator*(const TransposedMatrix<T, N, K, S1, L1>& matrix1, const TransposedMatrix<T, M, N, S2, L2>& matrix2) {
+        Matrix<T, K, M> result{};
+        constexpr auto opA = TransposedMatrix<T, N, K, S1, L1>::ViewOperation;
+        constexpr auto opB = TransposedMatrix<T, M, N, S2, L2>::ViewOperation;
+        Kernels::gemm(opA, matrix1.view(), opB, matrix2.view(), result.view());
+        return result;
+    }
+
+    /**
+     * Multiplies two matrix expressions. Operands that aren't matrices yet,
+     * like the result of an element-wise calculation, are evaluated first so
+     * that the product kernels can work on contiguous memory. Transposes are
+     * passed through as they are, so they pick one of the overloads above.
+     *
+     * @tparam L The left expression type.
+     * @tparam R The right expression type.
+     * @tparam T The Matrix entry type.
+     * @tparam N The row count for the first matrix.
+     * @tparam K The column count and row count for the first and second matrices, respectively.
+     * @tparam M The column count for the second matrix.
+     * @param matrix1 The first matrix.
+     * @param matrix2 The second matrix.
+     * @return A new matrix holding the matrix product.
      */
-    template<size_t N, size_t M>
-    Matrix<double, N, M> operator-(const Matrix<double, N, M>& matrix) {
-        return -1.0 * matrix;
+    template<typename L, typename R, typename T, size_t N, size_t K, size_t M>
+    Matrix<T, N, M> operator*(const Expression<L, T, N, K>& matrix1, const Expression<R, T, K, M>& matrix2) {
+        return evaluate(matrix1.derived()) * evaluate(matrix2.derived());
     }
 
     /**
@@ -200,19 +1476,21 @@ namespace Matrix {
      *
      * @tparam N The number of rows.
      * @tparam M The numbero f columns.
+     * @tparam S The storage policy.
+     * @tparam L The layout policy.
      * @return A new matrix with random values between -1 and 1.
      */
-    template<size_t N, size_t M>
-    Matrix<double, N, M> randomMatrix() {
+    template<size_t N, size_t M, typename S = Storage::Automatic, typename L = Layout::RowMajor>
+    Matrix<double, N, M, S, L> randomMatrix() {
         std::random_device rd;
         std::mt19937 gen{rd()};
         std::uniform_real_distribution<> dis(-1, 1);
 
-        Matrix<double, N, M> result{};
+        Matrix<double, N, M, S, L> result{};
         for (size_t i = 0; i < N; ++i) {
             for (size_t j = 0; j < M; ++j) {
-                result[i][j] = dis(gen);
-                if (result[i][j] == 0) result[i][j] += 0.01;
+                result(i, j) = dis(gen);
+                if (result(i, j) == 0) result(i, j) += 0.01;
             }
         }
 
@@ -1,12 +1,21 @@
 #pragma once
+#include <array>
+#include <cmath>
 #include <cstdio>
 #include <fstream>
 #include <iostream>
 #include <stdexcept>
 #include <string>
 #include <vector>
+#include "activation.hpp"
+#include "allocator.hpp"
+#include "batch.hpp"
+#include "kernels.hpp"
+#include "layout.hpp"
 #include "math.hpp"
 #include "matrix.hpp"
+#include "sparse.hpp"
+#include "storage.hpp"
 
 namespace NeuralNetwork {
     /**
@@ -18,19 +27,33 @@ namespace NeuralNetwork {
     template<size_t N>
     using ColumnVector = Matrix::Matrix<double, N, 1>;
 
+    /**
+     * A batch of `B` column vectors of size `N`, stored as the columns of
+     * one matrix. Queries on a batch run every layer as a single matrix
+     * product. The batch is column-major, so every input is copied into it
+     * as one contiguous block.
+     *
+     * @tparam N The size of every column vector.
+     * @tparam B The number of column vectors.
+     */
+    template<size_t N, size_t B>
+    using Batch = Matrix::Batch<double, N, B, Storage::Automatic, Layout::ColumnMajor>;
+
     /**
      * A convenience type representing a Matrix of weights of size
-     * `CurrentLayerSize * PrevLayerSize`.
+     * `CurrentLayerSize * PrevLayerSize`. The weights are streamed through by
+     * every product in the network, so their rows are cache line aligned, and
+     * large weight matrices are backed by huge pages.
      *
      * @tparam CurrentLayerSize The size of the current layer.
      * @tparam PrevLayerSize The size of the previous layer.
      */
     template<size_t CurrentLayerSize, size_t PrevLayerSize>
-    using Weights = Matrix::Matrix<double, CurrentLayerSize, PrevLayerSize>;
+    using Weights = Matrix::Matrix<double, CurrentLayerSize, PrevLayerSize, Storage::HugePages>;
 
     /**
      * Data structure representing an instance of a image and its corresponding
-     * label.
+     * label. The input doesn't include the `inputOffset` of the network.
      *
      * @tparam InputSize The size of the input layer.
      * @tparam OutputSize The size of the output layer.
@@ -44,35 +67,103 @@ namespace NeuralNetwork {
 
     /**
      * Vector of training labels, representing the a data set of training
-     * labels.
+     * labels. The full MNIST training set takes up a few hundred megabytes,
+     * so it is backed by huge pages to cut down on TLB misses.
      *
      * @tparam InputSize The size of the input layer.
      * @tparam OutputSize The size of the output layer.
      */
     template<size_t InputSize, size_t OutputSize>
-    using TrainingSet = std::vector<TrainingLabel<InputSize, OutputSize>>;
+    using TrainingSet = std::vector<
+        TrainingLabel<InputSize, OutputSize>,
+        Allocator::AlignedAllocator<TrainingLabel<InputSize, OutputSize>, Allocator::cacheLine, true>
+    >;
+
+    /**
+     * Statistics gathered while training, averaged over every training label
+     * seen by the last call to `train()`. They are cheap enough to collect on
+     * every run.
+     */
+    struct TrainingStats {
+        size_t samples = 0;
+
+        /**
+         * The mean loss. This is the squared error `||label - output||^2 / 2`,
+         * or the cross-entropy `-sum(label * log(output))` for a softmax
+         * output layer.
+         */
+        double loss = 0;
+
+        /**
+         * The mean L2 norms of the gradients of the input and hidden weights.
+         */
+        double inputGradientNorm = 0;
+        double hiddenGradientNorm = 0;
+    };
 
     /**
      * Class representing a 3-layer neural network.
      *
+     * The first layer skips the zero inputs wherever that pays off, see
+     * `Matrix::SparseVector`. Inputs that would never be 0, like pixels
+     * shifted away from 0, are given without the shift, and the network adds
+     * it as `inputOffset`. The weights times the offset are a bias, kept as
+     * the offset times the sums of the rows of the input weights.
+     *
+     * The activation of each layer is a policy from `Activation`. They only
+     * change how the weights are used, not how they're stored, so weight
+     * files load into a network with any activations. They're only
+     * meaningful with the ones they were trained with, though, which is the
+     * sigmoid for existing files.
+     *
      * @tparam InputSize The size of input layer.
      * @tparam HiddenSize The size of hidden layer.
      * @tparam OutputSize The size of output layer.
+     * @tparam HiddenActivation The activation of the hidden layer, anything but the softmax. Defaults to the sigmoid.
+     * @tparam OutputActivation The activation of the output layer. Defaults to the sigmoid.
      */
-    template<size_t InputSize, size_t HiddenSize, size_t OutputSize>
+    template<
+        size_t InputSize,
+        size_t HiddenSize,
+        size_t OutputSize,
+        typename HiddenActivation = Activation::Sigmoid,
+        typename OutputActivation = Activation::Sigmoid
+    >
     class NeuralNetwork {
+        static_assert(!Activation::isSoftmax<HiddenActivation>, "The softmax can only be the activation of the output layer!");
+
     public:
         /**
          * Constructs a new neural network.
          *
          * @param learningRate The learning rate of the network.
          * @param verbose Enable verbose logging. Defaults to false.
+         * @param accuracy Whether to use the exact or the approximate sigmoid,
+         * in the activations that are based on it. Defaults to exact.
+         * @param inputOffset The constant added to every input, like
+         * `Math::pixelOffset`. Defaults to 0.
          */
-        NeuralNetwork(const double learningRate, const bool verbose = false) :
+        NeuralNetwork(
+            const double learningRate,
+            const bool verbose = false,
+            const Kernels::Accuracy accuracy = Kernels::Accuracy::Exact,
+            const double inputOffset = 0
+        ) :
             _learningRate{learningRate},
             _verbose{verbose},
-            _inputWeights{Matrix::randomMatrix<HiddenSize, InputSize>()},
-            _hiddenWeights{Matrix::randomMatrix<OutputSize, HiddenSize>()} {
+            _accuracy{accuracy},
+            _inputOffset{inputOffset},
+            _inputWeights{Matrix::randomMatrix<HiddenSize, InputSize, Storage::HugePages>()},
+            _hiddenWeights{Matrix::randomMatrix<OutputSize, HiddenSize, Storage::HugePages>()} {
+            // The weighted inputs of a softmax are only compared to each
+            // other, and weights between -1 and 1 would start them out tens
+            // apart, so the first outputs would be confidently wrong. Scaling
+            // the weights by `1 / sqrt(HiddenSize)` starts them out at most a
+            // few apart.
+            if constexpr (Activation::isSoftmax<OutputActivation>) {
+                _hiddenWeights *= 1 / std::sqrt(static_cast<double>(HiddenSize));
+            }
+            sumInputWeights();
         }
 
         /**
@@ -83,19 +174,43 @@ namespace NeuralNetwork {
          * @param input The input vector.
          */
         size_t query(const ColumnVector<InputSize>& input) const {
-            auto hiddenOutput = Math::sigmoid(_inputWeights * input);
-            auto output = Math::sigmoid(_hiddenWeights * hiddenOutput);
+            thread_local Matrix::SparseVector<double, InputSize> sparseInput;
+            sparseInput = input;
+            ColumnVector<HiddenSize> hiddenInput = weighInput(input, sparseInput);
+            hiddenInput.axpy(_inputOffset, _inputWeightSums);
+
+            auto hiddenOutput = HiddenActivation::forward(hiddenInput, _accuracy);
+            auto output = OutputActivation::forward(_hiddenWeights * hiddenOutput, _accuracy);
 
             // Pick result with highest probability of happening. It is up to
             // the caller of the API to interpret the result meaning in the
-            // context of the data set.{}
-            size_t result = 0;
-            for (size_t i = 1; i < OutputSize; ++i) {
-                if (output[i][0] <= output[result][0]) continue;
-                result = i;
-            }
+            // context of the data set.
+            return output.argmax();
+        }
 
-            return result;
+        /**
+         * Queries the results for a whole batch of inputs at once, see
+         * `query()`. Every layer is one matrix product over the batch, so
+         * the weights are streamed through once per batch rather than once
+         * per input. The inputs are multiplied as a dense matrix.
+         *
+         * @tparam B The number of inputs in the batch.
+         * @tparam S The storage policy of the batch.
+         * @tparam L The layout policy of the batch.
+         * @param inputs The batch of input vectors.
+         * @return The result for every input, in the order of the columns.
+         */
+        template<size_t B, typename S, typename L>
+        std::array<size_t, B> query(const Matrix::Batch<double, InputSize, B, S, L>& inputs) const {
+            Matrix::Matrix<double, HiddenSize, B> hiddenInput = _inputWeights * inputs;
+            hiddenInput.ger(_inputOffset, _inputWeightSums, ones<B>());
+
+            auto hiddenOutput = HiddenActivation::forward(hiddenInput, _accuracy);
+            auto output = OutputActivation::forward(_hiddenWeights * hiddenOutput, _accuracy);
+
+            std::array<size_t, B> results;
+            for (size_t j = 0; j < B; ++j) results[j] = Kernels::argmax<double>(output.view().colRange(j, j + 1));
+            return results;
         }
 
         /**
@@ -108,32 +223,65 @@ namespace NeuralNetwork {
             // These values are used for percentages when verbose output is enabled.
             size_t labelNumber = 1;
             auto trainingSetSize = trainingSet.size();
+            _stats = TrainingStats{};
+            _stats.samples = trainingSetSize;
+
+            // The updates of the input weights are split in two. The part
+            // from the non-zero inputs goes straight into the weights, only
+            // touching their columns. The part from the offset would touch
+            // every weight, so it is added up per row here, and only added
+            // to the weights once we're done. Until then, the weights are
+            // `_inputWeights + pendingWeights * 1^T`.
+            ColumnVector<HiddenSize> pendingWeights{};
 
             for (const auto& trainingLabel : trainingSet) {
-                // First we preprare the input to the hidden layer and its
-                // output using the sigmoid function.
-                auto hiddenInput = _inputWeights * trainingLabel.input;
-                auto hiddenOutput = Math::sigmoid(hiddenInput);
+                // First we preprare the output of the hidden layer using
+                // its activation function. Sparse enough inputs only read
+                // the columns of the weights for non-zero inputs, and the
+                // rest of the input weights times the input is
+                // `pendingWeights * sum(input) + inputOffset * weightSums`.
+                _sparseInput = trainingLabel.input;
+                const double inputSum = trainingLabel.input.sum();
+                ColumnVector<HiddenSize> hiddenInput = weighInput(trainingLabel.input, _sparseInput);
+                hiddenInput.axpy(inputSum, pendingWeights).axpy(_inputOffset, _inputWeightSums);
+                auto hiddenOutput = HiddenActivation::forward(hiddenInput, _accuracy);
 
-                // Next, we prepare the input to the output layer as well as
-                // its output.
-                auto outputInput = _hiddenWeights * hiddenOutput;
-                auto output = Math::sigmoid(outputInput);
+                // Next, we prepare the output of the output layer.
+                auto output = OutputActivation::forward(_hiddenWeights * hiddenOutput, _accuracy);
 
 
                 // Now, we calculate how far off we are and backpropogate those errors.
-                auto outputErrors = trainingLabel.label - output;
+                ColumnVector<OutputSize> outputErrors = trainingLabel.label - output;
                 auto hiddenErrors = _hiddenWeights.transpose() * outputErrors;
 
-                // Calculate the derivatives of the error functions.
-                auto outputErrorsDerivative = (-outputErrors ^ Math::sigmoid(outputInput, true)) * hiddenOutput.transpose();
-                auto hiddenErrorsDerivative = (-hiddenErrors ^ Math::sigmoid(hiddenInput, true)) * trainingLabel.input.transpose();
+                // Calculate the error gradients at the inputs of both layers.
+                // The derivative of the error with respect to the weights is
+                // `-gradient * layerInput^T`. The derivatives of the
+                // activations come from the outputs we already have, not from
+                // another pass over the weighted inputs. With a softmax
+                // output, the errors already are the gradient of the
+                // cross-entropy.
+                ColumnVector<OutputSize> outputGradient = outputLayerGradient(outputErrors, output);
+                ColumnVector<HiddenSize> hiddenGradient = hiddenErrors ^ HiddenActivation::derivative(hiddenOutput);
+
+                // Keep track of the loss and the size of the steps we take.
+                // The norm of an outer product is the product of the norms of
+                // its vectors, so the gradients never have to be formed.
+                _stats.loss += loss(trainingLabel.label, outputErrors, output);
+                _stats.hiddenGradientNorm += outputGradient.norm() * hiddenOutput.norm();
+                const double inputSquaredNorm = trainingLabel.input.squaredNorm()
+                    + _inputOffset * (2 * inputSum + _inputOffset * InputSize);
+                _stats.inputGradientNorm += hiddenGradient.norm() * std::sqrt(inputSquaredNorm);
 
-                // Update the weights using the derivatives from earlier.
+                // Update the weights using the gradients from earlier.
                 // Gradient descent slowly minimizes the error over time after
-                // many iterations.
-                _hiddenWeights = _hiddenWeights - _learningRate * outputErrorsDerivative;
-                _inputWeights = _inputWeights - _learningRate * hiddenErrorsDerivative;
+                // many iterations. Each step is a rank-1 update applied to
+                // the weights in place, without forming the outer product.
+                _hiddenWeights.ger(_learningRate, outputGradient, hiddenOutput);
+                if (_sparseInput.isSparse(Matrix::sparseUpdateDensity)) _inputWeights.ger(_learningRate, hiddenGradient, _sparseInput);
+                else _inputWeights.ger(_learningRate, hiddenGradient, trainingLabel.input);
+                pendingWeights.axpy(_learningRate * _inputOffset, hiddenGradient);
+                _inputWeightSums.axpy(_learningRate * (inputSum + _inputOffset * InputSize), hiddenGradient);
 
                 // Finally, print the percentage for training the network.
                 printPercentage("Training Network", labelNumber, trainingSetSize);
@@ -141,6 +289,24 @@ namespace NeuralNetwork {
             }
 
             endPercentage();
+
+            if (_inputOffset != 0) _inputWeights.ger(1.0, pendingWeights, ones<InputSize>());
+            sumInputWeights();
+
+            if (_stats.samples == 0) return;
+            _stats.loss /= _stats.samples;
+            _stats.hiddenGradientNorm /= _stats.samples;
+            _stats.inputGradientNorm /= _stats.samples;
+        }
+
+        /**
+         * Gets the statistics gathered by the last call to `train()`.
+         *
+         * @return The training statistics, with no samples if the network
+         * hasn't been trained.
+         */
+        const TrainingStats& trainingStats() const noexcept {
+            return _stats;
         }
 
         /**
@@ -175,6 +341,7 @@ namespace NeuralNetwork {
                 std::ifstream stream{file};
                 loadMatrix("Loading Input Weights from File", stream, _inputWeights);
                 loadMatrix("Loading Hidden Weights from File", stream, _hiddenWeights);
+                sumInputWeights();
             } catch (const std::ifstream::failure&) {
                 printMessage("Unable to read weights from file. Restorting to full training of network.");
                 return false;
@@ -189,10 +356,107 @@ namespace NeuralNetwork {
     private:
         double _learningRate;
         bool _verbose;
+        Kernels::Accuracy _accuracy;
+        double _inputOffset;
 
         Weights<HiddenSize, InputSize> _inputWeights;
         Weights<OutputSize, HiddenSize> _hiddenWeights;
 
+        // The sums of the rows of the input weights, which times
+        // `_inputOffset` is the bias of the offset.
+        ColumnVector<HiddenSize> _inputWeightSums;
+
+        // The training input as a sparse vector. Its buffers are reused
+        // for every training label.
+        Matrix::SparseVector<double, InputSize> _sparseInput;
+
+        TrainingStats _stats;
+
+        /**
+         * Gets a column vector of ones, which turns a rank-1 update into
+         * adding a column to every column, or multiplying by it into the sums
+         * of the rows.
+         *
+         * @tparam N The size of the column vector.
+         * @return The column vector of ones.
+         */
+        template<size_t N>
+        static ColumnVector<N> ones() {
+            ColumnVector<N> result;
+            result.fill(1);
+            return result;
+        }
+
+        /**
+         * Sums up the rows of the input weights into `_inputWeightSums`. This
+         * is done whenever the input weights are replaced, and after
+         * training, which updates the sums along the way but lets rounding
+         * errors pile up.
+         */
+        void sumInputWeights() {
+            _inputWeightSums = _inputWeights * ones<InputSize>();
+        }
+
+        /**
+         * Multiplies the input weights by an input. Only the columns of the
+         * weights for its non-zero entries are read if it's sparse enough
+         * for that, see `Matrix::sparseProductDensity`. Otherwise the dense
+         * input is multiplied as is, rather than expanding the sparse one.
+         *
+         * @param input The input.
+         * @param sparseInput The same input as a sparse vector.
+         * @return The input weights times the input.
+         */
+        ColumnVector<HiddenSize> weighInput(
+            const ColumnVector<InputSize>& input,
+            const Matrix::SparseVector<double, InputSize>& sparseInput
+        ) const {
+            if (sparseInput.isSparse()) return _inputWeights * sparseInput;
+            return _inputWeights * input;
+        }
+
+        /**
+         * Calculates the error gradient at the inputs of the output layer.
+         * This is the errors times the derivative of the activation, or just
+         * the errors for a softmax, see `Activation::Softmax`.
+         *
+         * @param errors The errors, `label - output`.
+         * @param output The output of the output layer.
+         * @return The gradient.
+         */
+        static ColumnVector<OutputSize> outputLayerGradient(
+            const ColumnVector<OutputSize>& errors,
+            const ColumnVector<OutputSize>& output
+        ) {
+            if constexpr (Activation::isSoftmax<OutputActivation>) return errors;
+            else return errors ^ OutputActivation::derivative(output);
+        }
+
+        /**
+         * Calculates the loss for one training label, see
+         * `TrainingStats::loss`.
+         *
+         * @param label The label.
+         * @param errors The errors, `label - output`.
+         * @param output The output of the output layer.
+         * @return The loss.
+         */
+        static double loss(
+            const ColumnVector<OutputSize>& label,
+            const ColumnVector<OutputSize>& errors,
+            const ColumnVector<OutputSize>& output
+        ) {
+            if constexpr (Activation::isSoftmax<OutputActivation>) {
+                double loss = 0;
+                for (size_t i = 0; i < OutputSize; ++i) {
+                    if (label(i, 0) > 0) loss -= label(i, 0) * std::log(output(i, 0));
+                }
+                return loss;
+            } else {
+                return errors.squaredNorm() / 2;
+            }
+        }
+
         /**
          * Prints a message if verbose output is enabled.
          *
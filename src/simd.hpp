@@ -0,0 +1,499 @@
+#pragma once
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <type_traits>
+
+/**
+ * The instruction set the vector kernels are compiled for: 0 for plain
+ * scalar code, 1 for SSE2, 2 for AVX2 with FMA and 3 for AVX-512. It defaults
+ * to the widest one the target flags allow. The runtime dispatch translation
+ * units set it themselves, see `dispatch.hpp`.
+ */
+#if !defined(SIMD_LEVEL)
+#if defined(__AVX512F__)
+#define SIMD_LEVEL 3
+#elif defined(__AVX2__) && defined(__FMA__)
+#define SIMD_LEVEL 2
+#elif defined(__SSE2__)
+#define SIMD_LEVEL 1
+#else
+#define SIMD_LEVEL 0
+#endif
+#endif
+
+/**
+ * Everything that is compiled differently for each instruction set lives in
+ * an inline namespace named after it. Code built for several of them can be
+ * linked into one binary without the linker merging, say, the AVX-512 and the
+ * SSE2 instantiation of the same kernel.
+ */
+#if SIMD_LEVEL == 3
+#define SIMD_NAMESPACE Avx512
+#elif SIMD_LEVEL == 2
+#define SIMD_NAMESPACE Avx2
+#elif SIMD_LEVEL == 1
+#define SIMD_NAMESPACE Sse2
+#else
+#define SIMD_NAMESPACE Scalar
+#endif
+
+#if SIMD_LEVEL > 0
+#include <immintrin.h>
+#endif
+
+namespace Simd {
+inline namespace SIMD_NAMESPACE {
+    /**
+     * Added to an integral `n` to get `2^n` with `Vector::pow2()`. Adding
+     * `2^52` to a small integer leaves the integer in the low bits of the
+     * mantissa, where the exponent bias is added right along with it. A
+     * shift then moves the biased exponent into place. Floats work the same
+     * with `2^23` and their own bias.
+     *
+     * @tparam T The entry type, float or double.
+     */
+    template<typename T>
+    constexpr T pow2Bias = sizeof(T) == sizeof(float) ? T(1 << 23) + 127 : T(1LL << 52) + 1023;
+
+    /**
+     * Thin wrapper around the widest vector registers available for entries
+     * of type `T`. The instruction set is picked at compile time from the
+     * target flags (see `ARCH` in the Makefile), so the kernels can be written
+     * once against this interface.
+     *
+     * The generic version is a "vector" of one scalar, which lets every
+     * kernel fall back to plain scalar code for types we have no intrinsics
+     * for.
+     *
+     * @tparam T The entry type.
+     */
+    template<typename T>
+    struct Vector {
+        using Register = T;
+        static constexpr size_t width = 1;
+
+        static Register zero() { return T{}; }
+        static Register broadcast(const T value) { return value; }
+        static Register load(const T* pointer) { return *pointer; }
+        static void store(T* pointer, const Register value) { *pointer = value; }
+        static Register add(const Register a, const Register b) { return a + b; }
+        static Register sub(const Register a, const Register b) { return a - b; }
+        static Register mul(const Register a, const Register b) { return a * b; }
+        static Register div(const Register a, const Register b) { return a / b; }
+        static Register fma(const Register a, const Register b, const Register c) { return a * b + c; }
+        static Register max(const Register a, const Register b) { return a < b ? b : a; }
+        static Register min(const Register a, const Register b) { return b < a ? b : a; }
+        static Register step(const Register a) { return a > T{} ? T{1} : T{}; }
+        static T sum(const Register value) { return value; }
+    };
+
+#if SIMD_LEVEL == 3
+    template<>
+    struct Vector<double> {
+        using Register = __m512d;
+        static constexpr size_t width = 8;
+
+        static Register zero() { return _mm512_setzero_pd(); }
+        static Register broadcast(const double value) { return _mm512_set1_pd(value); }
+        static Register load(const double* pointer) { return _mm512_loadu_pd(pointer); }
+        static void store(double* pointer, const Register value) { _mm512_storeu_pd(pointer, value); }
+        static Register add(const Register a, const Register b) { return _mm512_add_pd(a, b); }
+        static Register sub(const Register a, const Register b) { return _mm512_sub_pd(a, b); }
+        static Register mul(const Register a, const Register b) { return _mm512_mul_pd(a, b); }
+        static Register div(const Register a, const Register b) { return _mm512_div_pd(a, b); }
+        static Register fma(const Register a, const Register b, const Register c) { return _mm512_fmadd_pd(a, b, c); }
+        // The unmasked maximum passes an undefined register to the builtin,
+        // which trips the same warnings as `sum()`. An all-ones mask compiles
+        // to the same instruction.
+        static Register max(const Register a, const Register b) { return _mm512_mask_max_pd(a, 0xFF, a, b); }
+        static Register min(const Register a, const Register b) { return _mm512_mask_min_pd(a, 0xFF, a, b); }
+
+        static Register step(const Register a) {
+            return _mm512_maskz_mov_pd(_mm512_cmp_pd_mask(a, _mm512_setzero_pd(), _CMP_GT_OQ), _mm512_set1_pd(1));
+        }
+
+        // The unmasked shift has the same problem as the maximum.
+        static Register pow2(const Register n) {
+            const __m512i biased = _mm512_castpd_si512(_mm512_add_pd(n, _mm512_set1_pd(pow2Bias<double>)));
+            return _mm512_castsi512_pd(_mm512_mask_slli_epi64(biased, 0xFF, biased, 52));
+        }
+
+        static double sum(const Register value) {
+            // The lane extraction intrinsics trip GCC's uninitialized value
+            // warnings, and this only runs once per reduction anyway.
+            alignas(64) double lanes[8];
+            _mm512_store_pd(lanes, value);
+            return ((lanes[0] + lanes[1]) + (lanes[2] + lanes[3])) + ((lanes[4] + lanes[5]) + (lanes[6] + lanes[7]));
+        }
+    };
+
+    template<>
+    struct Vector<float> {
+        using Register = __m512;
+        static constexpr size_t width = 16;
+
+        static Register zero() { return _mm512_setzero_ps(); }
+        static Register broadcast(const float value) { return _mm512_set1_ps(value); }
+        static Register load(const float* pointer) { return _mm512_loadu_ps(pointer); }
+        static void store(float* pointer, const Register value) { _mm512_storeu_ps(pointer, value); }
+        static Register add(const Register a, const Register b) { return _mm512_add_ps(a, b); }
+        static Register sub(const Register a, const Register b) { return _mm512_sub_ps(a, b); }
+        static Register mul(const Register a, const Register b) { return _mm512_mul_ps(a, b); }
+        static Register div(const Register a, const Register b) { return _mm512_div_ps(a, b); }
+        static Register fma(const Register a, const Register b, const Register c) { return _mm512_fmadd_ps(a, b, c); }
+        static Register max(const Register a, const Register b) { return _mm512_mask_max_ps(a, 0xFFFF, a, b); }
+        static Register min(const Register a, const Register b) { return _mm512_mask_min_ps(a, 0xFFFF, a, b); }
+
+        static Register step(const Register a) {
+            return _mm512_maskz_mov_ps(_mm512_cmp_ps_mask(a, _mm512_setzero_ps(), _CMP_GT_OQ), _mm512_set1_ps(1));
+        }
+
+        static Register pow2(const Register n) {
+            const __m512i biased = _mm512_castps_si512(_mm512_add_ps(n, _mm512_set1_ps(pow2Bias<float>)));
+            return _mm512_castsi512_ps(_mm512_mask_slli_epi32(biased, 0xFFFF, biased, 23));
+        }
+
+        static float sum(const Register value) {
+            alignas(64) float lanes[16];
+            _mm512_store_ps(lanes, value);
+
+            float result = 0;
+            for (size_t i = 0; i < 16; i += 4) result += (lanes[i] + lanes[i + 1]) + (lanes[i + 2] + lanes[i + 3]);
+            return result;
+        }
+    };
+#elif SIMD_LEVEL == 2
+    template<>
+    struct Vector<double> {
+        using Register = __m256d;
+        static constexpr size_t width = 4;
+
+        static Register zero() { return _mm256_setzero_pd(); }
+        static Register broadcast(const double value) { return _mm256_set1_pd(value); }
+        static Register load(const double* pointer) { return _mm256_loadu_pd(pointer); }
+        static void store(double* pointer, const Register value) { _mm256_storeu_pd(pointer, value); }
+        static Register add(const Register a, const Register b) { return _mm256_add_pd(a, b); }
+        static Register sub(const Register a, const Register b) { return _mm256_sub_pd(a, b); }
+        static Register mul(const Register a, const Register b) { return _mm256_mul_pd(a, b); }
+        static Register div(const Register a, const Register b) { return _mm256_div_pd(a, b); }
+        static Register fma(const Register a, const Register b, const Register c) { return _mm256_fmadd_pd(a, b, c); }
+        static Register max(const Register a, const Register b) { return _mm256_max_pd(a, b); }
+        static Register min(const Register a, const Register b) { return _mm256_min_pd(a, b); }
+        static Register step(const Register a) { return _mm256_and_pd(_mm256_cmp_pd(a, zero(), _CMP_GT_OQ), broadcast(1)); }
+
+        static Register pow2(const Register n) {
+            const __m256i biased = _mm256_castpd_si256(_mm256_add_pd(n, _mm256_set1_pd(pow2Bias<double>)));
+            return _mm256_castsi256_pd(_mm256_slli_epi64(biased, 52));
+        }
+
+        static double sum(const Register value) {
+            __m128d half = _mm_add_pd(_mm256_castpd256_pd128(value), _mm256_extractf128_pd(value, 1));
+            return _mm_cvtsd_f64(_mm_add_sd(half, _mm_unpackhi_pd(half, half)));
+        }
+    };
+
+    template<>
+    struct Vector<float> {
+        using Register = __m256;
+        static constexpr size_t width = 8;
+
+        static Register zero() { return _mm256_setzero_ps(); }
+        static Register broadcast(const float value) { return _mm256_set1_ps(value); }
+        static Register load(const float* pointer) { return _mm256_loadu_ps(pointer); }
+        static void store(float* pointer, const Register value) { _mm256_storeu_ps(pointer, value); }
+        static Register add(const Register a, const Register b) { return _mm256_add_ps(a, b); }
+        static Register sub(const Register a, const Register b) { return _mm256_sub_ps(a, b); }
+        static Register mul(const Register a, const Register b) { return _mm256_mul_ps(a, b); }
+        static Register div(const Register a, const Register b) { return _mm256_div_ps(a, b); }
+        static Register fma(const Register a, const Register b, const Register c) { return _mm256_fmadd_ps(a, b, c); }
+        static Register max(const Register a, const Register b) { return _mm256_max_ps(a, b); }
+        static Register min(const Register a, const Register b) { return _mm256_min_ps(a, b); }
+        static Register step(const Register a) { return _mm256_and_ps(_mm256_cmp_ps(a, zero(), _CMP_GT_OQ), broadcast(1)); }
+
+        static Register pow2(const Register n) {
+            const __m256i biased = _mm256_castps_si256(_mm256_add_ps(n, _mm256_set1_ps(pow2Bias<float>)));
+            return _mm256_castsi256_ps(_mm256_slli_epi32(biased, 23));
+        }
+
+        static float sum(const Register value) {
+            __m128 half = _mm_add_ps(_mm256_castps256_ps128(value), _mm256_extractf128_ps(value, 1));
+            half = _mm_add_ps(half, _mm_movehl_ps(half, half));
+            return _mm_cvtss_f32(_mm_add_ss(half, _mm_shuffle_ps(half, half, 1)));
+        }
+    };
+#elif SIMD_LEVEL == 1
+    template<>
+    struct Vector<double> {
+        using Register = __m128d;
+        static constexpr size_t width = 2;
+
+        static Register zero() { return _mm_setzero_pd(); }
+        static Register broadcast(const double value) { return _mm_set1_pd(value); }
+        static Register load(const double* pointer) { return _mm_loadu_pd(pointer); }
+        static void store(double* pointer, const Register value) { _mm_storeu_pd(pointer, value); }
+        static Register add(const Register a, const Register b) { return _mm_add_pd(a, b); }
+        static Register sub(const Register a, const Register b) { return _mm_sub_pd(a, b); }
+        static Register mul(const Register a, const Register b) { return _mm_mul_pd(a, b); }
+        static Register div(const Register a, const Register b) { return _mm_div_pd(a, b); }
+        static Register fma(const Register a, const Register b, const Register c) { return _mm_add_pd(_mm_mul_pd(a, b), c); }
+        static Register max(const Register a, const Register b) { return _mm_max_pd(a, b); }
+        static Register min(const Register a, const Register b) { return _mm_min_pd(a, b); }
+        static Register step(const Register a) { return _mm_and_pd(_mm_cmpgt_pd(a, zero()), broadcast(1)); }
+
+        static Register pow2(const Register n) {
+            const __m128i biased = _mm_castpd_si128(_mm_add_pd(n, _mm_set1_pd(pow2Bias<double>)));
+            return _mm_castsi128_pd(_mm_slli_epi64(biased, 52));
+        }
+        static double sum(const Register value) { return _mm_cvtsd_f64(_mm_add_sd(value, _mm_unpackhi_pd(value, value))); }
+    };
+
+    template<>
+    struct Vector<float> {
+        using Register = __m128;
+        static constexpr size_t width = 4;
+
+        static Register zero() { return _mm_setzero_ps(); }
+        static Register broadcast(const float value) { return _mm_set1_ps(value); }
+        static Register load(const float* pointer) { return _mm_loadu_ps(pointer); }
+        static void store(float* pointer, const Register value) { _mm_storeu_ps(pointer, value); }
+        static Register add(const Register a, const Register b) { return _mm_add_ps(a, b); }
+        static Register sub(const Register a, const Register b) { return _mm_sub_ps(a, b); }
+        static Register mul(const Register a, const Register b) { return _mm_mul_ps(a, b); }
+        static Register div(const Register a, const Register b) { return _mm_div_ps(a, b); }
+        static Register fma(const Register a, const Register b, const Register c) { return _mm_add_ps(_mm_mul_ps(a, b), c); }
+        static Register max(const Register a, const Register b) { return _mm_max_ps(a, b); }
+        static Register min(const Register a, const Register b) { return _mm_min_ps(a, b); }
+        static Register step(const Register a) { return _mm_and_ps(_mm_cmpgt_ps(a, zero()), broadcast(1)); }
+
+        static Register pow2(const Register n) {
+            const __m128i biased = _mm_castps_si128(_mm_add_ps(n, _mm_set1_ps(pow2Bias<float>)));
+            return _mm_castsi128_ps(_mm_slli_epi32(biased, 23));
+        }
+
+        static float sum(const Register value) {
+            __m128 half = _mm_add_ps(value, _mm_movehl_ps(value, value));
+            return _mm_cvtss_f32(_mm_add_ss(half, _mm_shuffle_ps(half, half, 1)));
+        }
+    };
+#endif
+
+    /**
+     * One register's worth of entries, with the usual arithmetic operators.
+     * Element-wise functions that are written against these operators, like
+     * `[](const auto& x) { return x * x + 1.0; }`, work on both single
+     * entries and packets, so the same function can be run over whole
+     * registers and then over the entries left at the end of a row.
+     *
+     * @tparam T The entry type.
+     */
+    template<typename T>
+    struct Packet {
+        using Register = typename Vector<T>::Register;
+        static constexpr size_t width = Vector<T>::width;
+
+        Register value;
+
+        static Packet load(const T* pointer) { return {Vector<T>::load(pointer)}; }
+        static Packet broadcast(const T value) { return {Vector<T>::broadcast(value)}; }
+        void store(T* pointer) const { Vector<T>::store(pointer, value); }
+    };
+
+    template<typename T>
+    Packet<T> operator+(const Packet<T> a, const Packet<T> b) { return {Vector<T>::add(a.value, b.value)}; }
+
+    template<typename T>
+    Packet<T> operator-(const Packet<T> a, const Packet<T> b) { return {Vector<T>::sub(a.value, b.value)}; }
+
+    template<typename T>
+    Packet<T> operator*(const Packet<T> a, const Packet<T> b) { return {Vector<T>::mul(a.value, b.value)}; }
+
+    template<typename T>
+    Packet<T> operator/(const Packet<T> a, const Packet<T> b) { return {Vector<T>::div(a.value, b.value)}; }
+
+    template<typename T>
+    Packet<T> operator-(const Packet<T> a) { return {Vector<T>::sub(Vector<T>::zero(), a.value)}; }
+
+    // Mixing packets and scalars broadcasts the scalar. The scalar's type is
+    // not deduced, so literals like `1.0` or `2` convert to the entry type.
+
+    template<typename T>
+    Packet<T> operator+(const Packet<T> a, const std::common_type_t<T> b) { return a + Packet<T>::broadcast(b); }
+
+    template<typename T>
+    Packet<T> operator+(const std::common_type_t<T> a, const Packet<T> b) { return Packet<T>::broadcast(a) + b; }
+
+    template<typename T>
+    Packet<T> operator-(const Packet<T> a, const std::common_type_t<T> b) { return a - Packet<T>::broadcast(b); }
+
+    template<typename T>
+    Packet<T> operator-(const std::common_type_t<T> a, const Packet<T> b) { return Packet<T>::broadcast(a) - b; }
+
+    template<typename T>
+    Packet<T> operator*(const Packet<T> a, const std::common_type_t<T> b) { return a * Packet<T>::broadcast(b); }
+
+    template<typename T>
+    Packet<T> operator*(const std::common_type_t<T> a, const Packet<T> b) { return Packet<T>::broadcast(a) * b; }
+
+    template<typename T>
+    Packet<T> operator/(const Packet<T> a, const std::common_type_t<T> b) { return a / Packet<T>::broadcast(b); }
+
+    template<typename T>
+    Packet<T> operator/(const std::common_type_t<T> a, const Packet<T> b) { return Packet<T>::broadcast(a) / b; }
+
+    // Element-wise functions that work on single entries and on packets
+    // alike, for functions that can't be written with the operators alone.
+    // Called qualified, like `Simd::max(x, 0.0)`, they pick the right
+    // overload for either. Like the SSE instructions, `max()` and `min()`
+    // return their second argument if either one is NaN.
+
+    template<typename T>
+    std::enable_if_t<std::is_arithmetic<T>::value, T> max(const T a, const T b) { return a > b ? a : b; }
+
+    template<typename T>
+    Packet<T> max(const Packet<T> a, const Packet<T> b) { return {Vector<T>::max(a.value, b.value)}; }
+
+    template<typename T>
+    Packet<T> max(const Packet<T> a, const std::common_type_t<T> b) { return max(a, Packet<T>::broadcast(b)); }
+
+    template<typename T>
+    std::enable_if_t<std::is_arithmetic<T>::value, T> min(const T a, const T b) { return a < b ? a : b; }
+
+    template<typename T>
+    Packet<T> min(const Packet<T> a, const Packet<T> b) { return {Vector<T>::min(a.value, b.value)}; }
+
+    template<typename T>
+    Packet<T> min(const Packet<T> a, const std::common_type_t<T> b) { return min(a, Packet<T>::broadcast(b)); }
+
+    // The Heaviside step function: 1 where the entry is positive, 0 where
+    // it's zero, negative or NaN.
+
+    template<typename T>
+    std::enable_if_t<std::is_arithmetic<T>::value, T> step(const T x) { return x > T{} ? T{1} : T{}; }
+
+    template<typename T>
+    Packet<T> step(const Packet<T> x) { return {Vector<T>::step(x.value)}; }
+
+    /**
+     * The degree of the polynomial `exp()` uses by default, which keeps it
+     * within a few units in the last place of `std::exp`.
+     *
+     * @tparam T The entry type, float or double.
+     */
+    template<typename T>
+    constexpr size_t expDegree = sizeof(T) == sizeof(float) ? 7 : 13;
+
+    /**
+     * Gets the coefficients `1 / k!` of the Taylor polynomial of `e^x`.
+     *
+     * @tparam T The entry type.
+     * @tparam Degree The degree of the polynomial.
+     * @return The coefficients, lowest degree first.
+     */
+    template<typename T, size_t Degree>
+    constexpr std::array<T, Degree + 1> expCoefficients() {
+        std::array<T, Degree + 1> coefficients{};
+        long double factorial = 1;
+        for (size_t k = 0; k <= Degree; ++k) {
+            if (k > 0) factorial *= k;
+            coefficients[k] = static_cast<T>(1 / factorial);
+        }
+        return coefficients;
+    }
+
+    /**
+     * Computes `e^x` for every lane of a register.
+     *
+     * The argument is split into `x = n * ln(2) + r` with an integral `n` and
+     * `|r| <= ln(2) / 2`, so that `e^x = 2^n * e^r`. The Taylor polynomial of
+     * `Degree`, at least 1, approximates `e^r`, and `2^n` is built right in the exponent
+     * bits, see `pow2Bias`. The polynomial's relative error is at most
+     * `sqrt(2) * (ln(2) / 2)^(Degree + 1) / (Degree + 1)!`.
+     *
+     * `x` is clamped to the range where `2^n` is a normal number, so large
+     * arguments give a huge finite result rather than infinity, and very
+     * negative ones a tiny one rather than zero. NaNs are passed through.
+     * Registers of a single scalar just call `std::exp`.
+     *
+     * @tparam T The entry type, float or double.
+     * @tparam Degree The degree of the polynomial.
+     * @param x The register.
+     * @return `e^x` for every lane.
+     */
+    template<typename T, size_t Degree = expDegree<T>>
+    typename Vector<T>::Register exp(const typename Vector<T>::Register x) {
+        using V = Vector<T>;
+        if constexpr (V::width == 1) {
+            return std::exp(x);
+        } else {
+            constexpr bool isFloat = sizeof(T) == sizeof(float);
+            constexpr T largest = isFloat ? 88 : 709;
+            constexpr T smallest = isFloat ? -87 : -708;
+            constexpr T log2e = 1.44269504088896340736;
+
+            // ln(2) in two parts, the first with few enough bits that
+            // `n * ln2High` is exact. The second makes up the difference.
+            constexpr T ln2High = isFloat ? 0.693359375 : 0.693145751953125;
+            constexpr T ln2Low = isFloat ? -2.12194440e-4 : 1.42860682030941723212e-6;
+
+            // Adding and subtracting 1.5 * 2^52 (or 2^23) rounds to the
+            // nearest integer, since the sum has no bits left for a fraction.
+            constexpr T rounding = isFloat ? T(3 << 22) : T(3LL << 51);
+
+            const auto clamped = V::min(V::broadcast(largest), V::max(V::broadcast(smallest), x));
+            const auto n = V::sub(V::add(V::mul(clamped, V::broadcast(log2e)), V::broadcast(rounding)), V::broadcast(rounding));
+            auto r = V::sub(clamped, V::mul(n, V::broadcast(ln2High)));
+            r = V::sub(r, V::mul(n, V::broadcast(ln2Low)));
+
+            // The polynomial 1 + r + r^2 / 2! + ... + r^Degree / Degree! is
+            // split into its even and odd powers, `even(r^2) + r * odd(r^2)`.
+            // Horner's scheme on both halves gives two independent chains of
+            // multiply-adds, each half as long as one chain for the whole.
+            static constexpr auto coefficients = expCoefficients<T, Degree>();
+            constexpr size_t highestEven = Degree - Degree % 2;
+            constexpr size_t highestOdd = Degree - (Degree + 1) % 2;
+
+            const auto square = V::mul(r, r);
+            auto even = V::broadcast(coefficients[highestEven]);
+            auto odd = V::broadcast(coefficients[highestOdd]);
+#pragma GCC unroll 8
+            for (size_t k = highestEven; k >= 2; k -= 2) even = V::fma(even, square, V::broadcast(coefficients[k - 2]));
+#pragma GCC unroll 8
+            for (size_t k = highestOdd; k >= 3; k -= 2) odd = V::fma(odd, square, V::broadcast(coefficients[k - 2]));
+
+            return V::mul(V::fma(odd, r, even), V::pow2(n));
+        }
+    }
+
+    /**
+     * Computes `e^x` for every entry of a packet, see `exp()` above. Found by
+     * argument-dependent lookup, so element-wise functions can call `exp(x)`
+     * after `using std::exp;` and work on single entries and packets alike.
+     *
+     * @tparam T The entry type.
+     * @param x The packet.
+     * @return `e^x` for every entry.
+     */
+    template<typename T>
+    Packet<T> exp(const Packet<T> x) {
+        return {exp<T>(x.value)};
+    }
+
+    /**
+     * The name of the instruction set the vector kernels were compiled for.
+     *
+     * @return One of "avx512", "avx2", "sse2" or "scalar".
+     */
+    constexpr const char* isa() {
+#if SIMD_LEVEL == 3
+        return "avx512";
+#elif SIMD_LEVEL == 2
+        return "avx2";
+#elif SIMD_LEVEL == 1
+        return "sse2";
+#else
+        return "scalar";
+#endif
+    }
+} // SIMD_NAMESPACE
+} // Simd
@@ -0,0 +1,260 @@
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <stdexcept>
+#include <vector>
+#include "kernels.hpp"
+#include "layout.hpp"
+#include "matrix.hpp"
+#include "storage.hpp"
+#include "view.hpp"
+
+namespace Matrix {
+    /**
+     * Class representing an `N * M` matrix of which only the non-zero entries
+     * are stored, in compressed sparse row (CSR) form. Products with dense
+     * matrices and rank-1 updates only visit those entries, which pays off
+     * for operands that are mostly zero, like the blank background of an
+     * image.
+     *
+     * The layout policy works like it does for `Matrix`. A column-major
+     * sparse matrix stores the compressed rows of its transpose, which are
+     * its compressed columns (CSC), and the kernels read it through the
+     * transposed `Kernels::Operation`.
+     *
+     * Sparse matrices are built from dense ones and are read-only after
+     * that. A sparse matrix that isn't sparse enough for an operation, see
+     * `isSparse()`, still works everywhere, but is handled as a dense matrix.
+     *
+     * @tparam T The entry type.
+     * @tparam N The number of rows.
+     * @tparam M The number of columns.
+     * @tparam L The layout policy.
+     */
+    template<typename T, size_t N, size_t M, typename L = Layout::RowMajor>
+    class SparseMatrix {
+    public:
+        static constexpr size_t Rows = N;
+        static constexpr size_t Cols = M;
+
+        /**
+         * How the kernels read the compressed matrix to get this one.
+         */
+        static constexpr Kernels::Operation ViewOperation = L::operation;
+
+        /**
+         * Constructs an all-zero sparse matrix.
+         */
+        SparseMatrix() : _offsets(StoredRows + 1, 0) {
+        }
+
+        /**
+         * Constructs a sparse matrix from the non-zero entries of a dense
+         * one.
+         *
+         * @tparam S The storage policy of the dense matrix.
+         * @tparam L2 The layout policy of the dense matrix.
+         * @param matrix The dense matrix.
+         */
+        template<typename S, typename L2>
+        explicit SparseMatrix(const Matrix<T, N, M, S, L2>& matrix) {
+            compress(matrix);
+        }
+
+        /**
+         * Replaces the entries with the non-zero entries of a dense matrix.
+         * The buffers are reused, so converting one input after another
+         * doesn't allocate once they've grown large enough.
+         *
+         * @tparam S The storage policy of the dense matrix.
+         * @tparam L2 The layout policy of the dense matrix.
+         * @param matrix The dense matrix.
+         * @return This sparse matrix.
+         */
+        template<typename S, typename L2>
+        SparseMatrix& operator=(const Matrix<T, N, M, S, L2>& matrix) {
+            compress(matrix);
+            return *this;
+        }
+
+        /**
+         * Gets the number of stored, non-zero entries.
+         *
+         * @return The number of non-zero entries.
+         */
+        size_t nonZeros() const noexcept {
+            return _values.size();
+        }
+
+        /**
+         * Gets the fraction of entries that are non-zero.
+         *
+         * @return The density, between 0 and 1.
+         */
+        double density() const noexcept {
+            return N * M == 0 ? 0 : static_cast<double>(nonZeros()) / (N * M);
+        }
+
+        /**
+         * Whether this matrix is sparse enough for the sparse kernels of an
+         * operation. Each operation has its own limit, since the dense
+         * kernels they compete with cost more or less per entry.
+         *
+         * @param limit The largest density the operation runs sparse at,
+         * `sparseProductDensity` for products.
+         * @return True if the sparse kernels are used.
+         */
+        bool isSparse(const double limit = sparseProductDensity) const noexcept {
+            return density() <= limit;
+        }
+
+        /**
+         * Gets the entry at `(i, j)`, which takes a binary search through the
+         * compressed row.
+         *
+         * @param i The row index.
+         * @param j The column index.
+         * @throws std::out_of_range
+         * @return The entry at `(i, j)`.
+         */
+        T operator()(const size_t i, const size_t j) const {
+            if (i >= N || j >= M) throw std::out_of_range{"`(i, j)` is out of range!"};
+
+            const size_t row = Layout::isRowMajor<L> ? i : j;
+            const size_t col = Layout::isRowMajor<L> ? j : i;
+            const auto begin = _columns.begin() + _offsets[row];
+            const auto end = _columns.begin() + _offsets[row + 1];
+            const auto entry = std::lower_bound(begin, end, col);
+            return entry != end && *entry == col ? _values[entry - _columns.begin()] : T{};
+        }
+
+        /**
+         * Gets the sparse view of the compressed matrix, which is the
+         * transpose of this one if it's column-major, see `ViewOperation`.
+         *
+         * @return The sparse view.
+         */
+        SparseView<T> view() const noexcept {
+            return {StoredRows, StoredCols, _offsets.data(), _columns.data(), _values.data()};
+        }
+
+        /**
+         * Expands this matrix into a dense one.
+         *
+         * @tparam S The storage policy of the dense matrix.
+         * @tparam L2 The layout policy of the dense matrix.
+         * @return The dense matrix.
+         */
+        template<typename S = Storage::Automatic, typename L2 = Layout::RowMajor>
+        Matrix<T, N, M, S, L2> toMatrix() const {
+            Matrix<T, N, M, S, L2> result{};
+            for (size_t row = 0; row < StoredRows; ++row) {
+                for (size_t e = _offsets[row]; e < _offsets[row + 1]; ++e) {
+                    if constexpr (Layout::isRowMajor<L>) result(row, _columns[e]) = _values[e];
+                    else result(_columns[e], row) = _values[e];
+                }
+            }
+            return result;
+        }
+
+    private:
+        static constexpr size_t StoredRows = L::storedRows(N, M);
+        static constexpr size_t StoredCols = L::storedCols(N, M);
+
+        std::vector<size_t> _offsets;
+        std::vector<size_t> _columns;
+        std::vector<T> _values;
+
+        /**
+         * Stores the non-zero entries of a dense matrix, one stored row at a
+         * time.
+         *
+         * @tparam S The storage policy of the dense matrix.
+         * @tparam L2 The layout policy of the dense matrix.
+         * @param matrix The dense matrix.
+         */
+        template<typename S, typename L2>
+        void compress(const Matrix<T, N, M, S, L2>& matrix) {
+            _offsets.assign(1, 0);
+            _columns.clear();
+            _values.clear();
+
+            for (size_t row = 0; row < StoredRows; ++row) {
+                for (size_t col = 0; col < StoredCols; ++col) {
+                    const T value = Layout::isRowMajor<L> ? matrix(row, col) : matrix(col, row);
+                    if (value == T{}) continue;
+                    _columns.push_back(col);
+                    _values.push_back(value);
+                }
+                _offsets.push_back(_values.size());
+            }
+        }
+    };
+
+    /**
+     * A sparse column vector of size `N`. It's column-major, so all of its
+     * non-zero entries end up in the single compressed row of its transpose.
+     *
+     * @tparam T The entry type.
+     * @tparam N The size of the vector.
+     */
+    template<typename T, size_t N>
+    using SparseVector = SparseMatrix<T, N, 1, Layout::ColumnMajor>;
+
+    /**
+     * Multiplies a sparse matrix by a dense one, skipping the zero entries of
+     * the sparse matrix. If it's denser than `sparseProductDensity`, it's
+     * expanded and multiplied by the dense product instead.
+     *
+     * @tparam T The Matrix entry type.
+     * @tparam N The row count for the first matrix.
+     * @tparam K The column count and row count for the first and second matrices, respectively.
+     * @tparam M The column count for the second matrix.
+     * @tparam L1 The layout policy of the first matrix.
+     * @tparam S2 The storage policy of the second matrix.
+     * @tparam L2 The layout policy of the second matrix.
+     * @param matrix1 The sparse matrix.
+     * @param matrix2 The dense matrix.
+     * @return A new matrix holding the matrix product.
+     */
+    template<typename T, size_t N, size_t K, size_t M, typename L1, typename S2, typename L2>
+    Matrix<T, N, M> operator*(const SparseMatrix<T, N, K, L1>& matrix1, const Matrix<T, K, M, S2, L2>& matrix2) {
+        if (!matrix1.isSparse()) return matrix1.toMatrix() * matrix2;
+
+        Matrix<T, N, M> result{};
+        constexpr auto opA = SparseMatrix<T, N, K, L1>::ViewOperation;
+        constexpr auto opB = Matrix<T, K, M, S2, L2>::ViewOperation;
+        Kernels::gemm(opA, matrix1.view(), opB, matrix2.view(), result.view());
+        return result;
+    }
+
+    /**
+     * Multiplies a dense matrix by a sparse one, skipping the zero entries of
+     * the sparse matrix. With a `SparseVector`, this is a matrix-vector
+     * product that only reads the columns of the dense matrix where the
+     * vector is non-zero. If the sparse matrix is denser than
+     * `sparseProductDensity`, it's expanded and multiplied by the dense
+     * product instead.
+     *
+     * @tparam T The Matrix entry type.
+     * @tparam N The row count for the first matrix.
+     * @tparam K The column count and row count for the first and second matrices, respectively.
+     * @tparam M The column count for the second matrix.
+     * @tparam S1 The storage policy of the first matrix.
+     * @tparam L1 The layout policy of the first matrix.
+     * @tparam L2 The layout policy of the second matrix.
+     * @param matrix1 The dense matrix.
+     * @param matrix2 The sparse matrix.
+     * @return A new matrix holding the matrix product.
+     */
+    template<typename T, size_t N, size_t K, size_t M, typename S1, typename L1, typename L2>
+    Matrix<T, N, M> operator*(const Matrix<T, N, K, S1, L1>& matrix1, const SparseMatrix<T, K, M, L2>& matrix2) {
+        if (!matrix2.isSparse()) return matrix1 * matrix2.toMatrix();
+
+        Matrix<T, N, M> result{};
+        constexpr auto opA = Matrix<T, N, K, S1, L1>::ViewOperation;
+        constexpr auto opB = SparseMatrix<T, K, M, L2>::ViewOperation;
+        Kernels::gemm(opA, matrix1.view(), opB, matrix2.view(), result.view());
+        return result;
+    }
+} // Matrix
@@ -0,0 +1,192 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+#include "allocator.hpp"
+
+namespace Storage {
+    /**
+     * Matrices whose entries take up at most this many bytes are stored
+     * inline by `Storage::Automatic`. Anything larger goes on the heap, so
+     * that big weight matrices never end up on the stack.
+     */
+    constexpr size_t inlineLimit = 16 * 1024;
+
+    /**
+     * Buffer holding the `N * M` entries of a matrix directly inside the
+     * object. Copies and moves copy every entry.
+     *
+     * @tparam T The entry type.
+     * @tparam N The number of rows.
+     * @tparam M The number of columns.
+     */
+    template<typename T, size_t N, size_t M>
+    class InlineBuffer {
+    public:
+        /**
+         * The distance between the starts of two consecutive rows.
+         */
+        static constexpr size_t stride = M;
+
+        T* data() noexcept {
+            return _entries.data();
+        }
+
+        const T* data() const noexcept {
+            return _entries.data();
+        }
+
+        void swap(InlineBuffer& other) noexcept {
+            _entries.swap(other._entries);
+        }
+
+    private:
+        std::array<T, N * M> _entries;
+    };
+
+    /**
+     * Buffer holding `N` rows of `Stride` entries in one contiguous block on
+     * the heap, of which the first `M` of every row are used. The block is
+     * aligned to `Alignment` and zero initialized, including the padding.
+     * Copies allocate a new block, while moves and swaps only exchange
+     * pointers.
+     *
+     * A moved-from buffer doesn't own any memory. It can be assigned to or
+     * destroyed, but not read from.
+     *
+     * @tparam T The entry type.
+     * @tparam N The number of rows.
+     * @tparam M The number of columns.
+     * @tparam Stride The distance between the starts of two consecutive rows.
+     * @tparam Alignment The alignment of the block.
+     * @tparam HugePages Whether to back large blocks with huge pages.
+     */
+    template<typename T, size_t N, size_t M, size_t Stride, size_t Alignment, bool HugePages>
+    class HeapBuffer {
+        static_assert(std::is_trivially_copyable<T>::value, "Heap buffers only hold trivially copyable entries!");
+        static_assert(Stride >= M, "The row stride can't be smaller than the row!");
+
+    public:
+        static constexpr size_t stride = Stride;
+
+        HeapBuffer() : _entries{allocate()} {
+            std::fill(_entries, _entries + size, T{});
+        }
+
+        HeapBuffer(const HeapBuffer& other) : _entries{allocate()} {
+            std::copy(other._entries, other._entries + size, _entries);
+        }
+
+        HeapBuffer(HeapBuffer&& other) noexcept : _entries{other._entries} {
+            other._entries = nullptr;
+        }
+
+        ~HeapBuffer() {
+            Allocator::deallocate(_entries, bytes, HugePages);
+        }
+
+        HeapBuffer& operator=(const HeapBuffer& other) {
+            if (this == &other) return *this;
+            if (_entries == nullptr) _entries = allocate();
+            std::copy(other._entries, other._entries + size, _entries);
+            return *this;
+        }
+
+        HeapBuffer& operator=(HeapBuffer&& other) noexcept {
+            swap(other);
+            return *this;
+        }
+
+        T* data() noexcept {
+            return _entries;
+        }
+
+        const T* data() const noexcept {
+            return _entries;
+        }
+
+        void swap(HeapBuffer& other) noexcept {
+            std::swap(_entries, other._entries);
+        }
+
+    private:
+        static constexpr size_t size = N * Stride;
+        static constexpr size_t bytes = size * sizeof(T);
+
+        T* _entries;
+
+        static T* allocate() {
+            return static_cast<T*>(Allocator::allocate(bytes, Alignment, HugePages));
+        }
+    };
+
+    /**
+     * Gets the row stride for rows of `M` entries padded to a multiple of
+     * the cache line size. Single entry rows, which is what column vectors
+     * are made of, are left unpadded so that vectors stay contiguous.
+     *
+     * @tparam T The entry type.
+     * @param m The number of columns.
+     * @return The padded row stride.
+     */
+    template<typename T>
+    constexpr size_t paddedStride(const size_t m) {
+        constexpr size_t lanes = Allocator::cacheLine % sizeof(T) == 0 ? Allocator::cacheLine / sizeof(T) : 1;
+        return m == 1 ? 1 : Allocator::roundUp(m, lanes);
+    }
+
+    /**
+     * Storage policy that keeps the entries inside the matrix object.
+     */
+    struct Inline {
+        template<typename T, size_t N, size_t M>
+        using Buffer = InlineBuffer<T, N, M>;
+    };
+
+    /**
+     * Storage policy that keeps the entries in one heap allocation, which
+     * makes moving and swapping matrices O(1) regardless of their size.
+     */
+    struct Heap {
+        template<typename T, size_t N, size_t M>
+        using Buffer = HeapBuffer<T, N, M, M, Allocator::cacheLine, false>;
+    };
+
+    /**
+     * Storage policy for matrices read by the vector kernels. Like `Heap`,
+     * but every row is padded to a whole number of cache lines, so every row
+     * starts on a cache line and full-width vector loads never straddle two
+     * lines.
+     */
+    struct Aligned {
+        template<typename T, size_t N, size_t M>
+        using Buffer = HeapBuffer<T, N, M, paddedStride<T>(M), Allocator::cacheLine, false>;
+    };
+
+    /**
+     * Like `Aligned`, but matrices of at least `Allocator::hugePageSize`
+     * bytes are backed by huge pages to reduce TLB misses when streaming
+     * through them.
+     */
+    struct HugePages {
+        template<typename T, size_t N, size_t M>
+        using Buffer = HeapBuffer<T, N, M, paddedStride<T>(M), Allocator::cacheLine, true>;
+    };
+
+    /**
+     * The default storage policy. Small matrices, like the column vectors
+     * passed between layers, are stored inline to avoid an allocation per
+     * temporary. Matrices larger than `inlineLimit` bytes are stored on the
+     * heap.
+     */
+    struct Automatic {
+        template<typename T, size_t N, size_t M>
+        using Buffer = std::conditional_t<
+            N * M * sizeof(T) <= inlineLimit,
+            Inline::Buffer<T, N, M>,
+            Heap::Buffer<T, N, M>
+        >;
+    };
+} // Storage
@@ -0,0 +1,253 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace Threads {
+    /**
+     * Fixed set of worker threads that stay alive for the whole run, so that
+     * splitting a kernel across cores only costs a wake-up instead of
+     * starting and joining threads every time.
+     *
+     * Work is handed out as a number of tasks. The calling thread works on
+     * them too, and `run()` returns once every task is done. Only one job
+     * runs at a time: if the pool is already busy, for example because a
+     * task itself calls into a parallel kernel, the job simply runs on the
+     * calling thread.
+     */
+    class ThreadPool {
+    public:
+        /**
+         * Starts a pool of `threads` threads in total, including the thread
+         * that calls `run()`, so `threads - 1` workers are started.
+         *
+         * @param threads The number of threads, at least 1.
+         */
+        explicit ThreadPool(const size_t threads) {
+            const size_t workers = std::max<size_t>(threads, 1) - 1;
+            _workers.reserve(workers);
+            for (size_t i = 0; i < workers; ++i) _workers.emplace_back([this] { work(); });
+        }
+
+        ThreadPool(const ThreadPool&) = delete;
+        ThreadPool& operator=(const ThreadPool&) = delete;
+
+        ~ThreadPool() {
+            {
+                std::lock_guard<std::mutex> lock{_mutex};
+                _stop = true;
+            }
+            _wake.notify_all();
+            for (auto& worker : _workers) worker.join();
+        }
+
+        /**
+         * Gets the number of threads working on a job, including the caller.
+         *
+         * @return The number of threads.
+         */
+        size_t size() const noexcept {
+            return _workers.size() + 1;
+        }
+
+        /**
+         * Calls `function(task)` for every `task` in `[0, tasks)`, spread
+         * over the pool, and waits until all of them are done. Tasks must be
+         * independent of each other. Jobs of `maxTasks` tasks or more run on
+         * the calling thread.
+         *
+         * @tparam F The function type.
+         * @param tasks The number of tasks.
+         * @param function The function to run for every task.
+         */
+        template<typename F>
+        void run(const size_t tasks, const F& function) {
+            std::unique_lock<std::mutex> busy{_busy, std::try_to_lock};
+            if (tasks <= 1 || tasks >= maxTasks || _workers.empty() || !busy.owns_lock()) {
+                for (size_t task = 0; task < tasks; ++task) function(task);
+                return;
+            }
+
+            Job job;
+            {
+                std::lock_guard<std::mutex> lock{_mutex};
+                job.context = &function;
+                job.invoke = [](const void* context, const size_t task) { (*static_cast<const F*>(context))(task); };
+                job.tasks = tasks;
+                job.generation = _job.generation + 1;
+                _job = job;
+                _next = ticket(job.generation, 0);
+                _remaining = tasks;
+            }
+            _wake.notify_all();
+
+            runTasks(job);
+
+            std::unique_lock<std::mutex> lock{_mutex};
+            _done.wait(lock, [this] { return _remaining == 0; });
+            _job.context = nullptr;
+            _job.invoke = nullptr;
+        }
+
+    private:
+        std::vector<std::thread> _workers;
+
+        // Held for the whole duration of a job, so that jobs never overlap.
+        std::mutex _busy;
+
+        std::mutex _mutex;
+        std::condition_variable _wake;
+        std::condition_variable _done;
+
+        /**
+         * A job, type erased so that handing it out never allocates. Every
+         * job gets the next generation, which tells the jobs apart.
+         */
+        struct Job {
+            const void* context = nullptr;
+            void (*invoke)(const void*, size_t) = nullptr;
+            size_t tasks = 0;
+            size_t generation = 0;
+        };
+
+        /**
+         * Tickets hold the generation of their job in the upper half and the
+         * index of a task in the lower half, so jobs have fewer tasks than
+         * this.
+         */
+        static constexpr size_t maxTasks = size_t{1} << 32;
+
+        // The current job. Workers copy it while holding `_mutex`, and only
+        // ever read their copy.
+        Job _job;
+
+        // The ticket of the next task of the current job, see `ticket()`.
+        std::atomic<uint64_t> _next{0};
+        size_t _remaining = 0;
+        bool _stop = false;
+
+        /**
+         * Gets the ticket for a task of a job. Only the lower half of the
+         * generation is kept, which still tells apart any two jobs a worker
+         * could see at the same time.
+         *
+         * @param generation The generation of the job.
+         * @param task The index of the task.
+         * @return The ticket.
+         */
+        static uint64_t ticket(const size_t generation, const size_t task) {
+            return (static_cast<uint64_t>(generation) << 32) + task;
+        }
+
+        /**
+         * Claims the next task of a job. A worker may still hold a job that
+         * has already finished, while `run()` has started the next one. Its
+         * generation no longer matches the ticket counter then, so it claims
+         * nothing and leaves the tickets of the new job alone.
+         *
+         * @param job The job to claim a task of.
+         * @param task Set to the index of the claimed task.
+         * @return True if a task was claimed, false if the job has none left.
+         */
+        bool claim(const Job& job, size_t& task) {
+            const uint64_t first = ticket(job.generation, 0);
+            uint64_t next = _next.load();
+            do {
+                if (next < first || next - first >= job.tasks) return false;
+            } while (!_next.compare_exchange_weak(next, next + 1));
+
+            task = next - first;
+            return true;
+        }
+
+        /**
+         * Claims and runs tasks of a job until there are none left.
+         *
+         * @param job The job to run tasks of.
+         */
+        void runTasks(const Job& job) {
+            size_t finished = 0;
+            for (size_t task; claim(job, task); ++finished) job.invoke(job.context, task);
+            if (finished == 0) return;
+
+            std::lock_guard<std::mutex> lock{_mutex};
+            _remaining -= finished;
+            if (_remaining == 0) _done.notify_one();
+        }
+
+        /**
+         * The loop every worker runs: sleep until there's a new job, help
+         * with it, and go back to sleep.
+         */
+        void work() {
+            Job job;
+            while (true) {
+                {
+                    std::unique_lock<std::mutex> lock{_mutex};
+                    _wake.wait(lock, [&] { return _stop || _job.generation != job.generation; });
+                    if (_stop) return;
+                    job = _job;
+                }
+                runTasks(job);
+            }
+        }
+    };
+
+    /**
+     * Gets the number of threads the shared pool starts with. This is the
+     * `NN_THREADS` environment variable if it is set to a positive number,
+     * and the number of cores otherwise.
+     *
+     * @return The default number of threads.
+     */
+    inline size_t defaultThreads() {
+        const char* variable = std::getenv("NN_THREADS");
+        if (variable != nullptr) {
+            const long threads = std::atol(variable);
+            if (threads > 0) return static_cast<size_t>(threads);
+        }
+        return std::max<size_t>(std::thread::hardware_concurrency(), 1);
+    }
+
+    /**
+     * The shared pool, created the first time a kernel needs it.
+     *
+     * @return The slot holding the shared pool.
+     */
+    inline std::unique_ptr<ThreadPool>& poolInstance() {
+        static std::unique_ptr<ThreadPool> instance;
+        return instance;
+    }
+
+    /**
+     * Gets the pool shared by all of the parallel kernels.
+     *
+     * @return The shared pool.
+     */
+    inline ThreadPool& pool() {
+        static std::once_flag created;
+        std::call_once(created, [] {
+            if (!poolInstance()) poolInstance() = std::make_unique<ThreadPool>(defaultThreads());
+        });
+        return *poolInstance();
+    }
+
+    /**
+     * Replaces the shared pool with one of `threads` threads. Setting it to
+     * 1 makes every kernel single threaded. This must not be called while a
+     * kernel is running.
+     *
+     * @param threads The number of threads, at least 1.
+     */
+    inline void setThreads(const size_t threads) {
+        pool();
+        poolInstance() = std::make_unique<ThreadPool>(threads);
+    }
+} // Threads
@@ -0,0 +1,129 @@
+#pragma once
+#include <cstddef>
+#include <fstream>
+#include <string>
+
+namespace Tuning {
+    /**
+     * The kernel parameters that depend on the machine rather than on the
+     * code: cache sizes decide the best blocking, and the number of cores
+     * and the cost of waking them decide when threads pay off. The defaults
+     * work well on most machines. `autotune()` measures better ones for the
+     * machine at hand, and `save()` and `load()` keep them between runs.
+     */
+    struct Parameters {
+        // Rows of A per packed block of the matrix product, a multiple of
+        // `Kernels::Blocking::MR`. An `mc * kc` block of A stays in L2.
+        size_t mc = 128;
+
+        // Depth of the packed blocks. `kc` rows of an `NR` wide panel of B
+        // stay in L1.
+        size_t kc = 256;
+
+        // Columns of B per packed panel. A `kc * nc` panel of B stays in L3.
+        size_t nc = 2048;
+
+        // Rows of A the matrix-vector product handles at once, which is how
+        // often every load of x is reused. One of 2, 4 or 8.
+        size_t gemvRows = 4;
+
+        // Products with at least this many multiply-adds are split across
+        // the thread pool. Below this, waking the workers costs more than
+        // it saves.
+        size_t parallelWork = 1 << 16;
+
+        // The size of the thread pool, or 0 for `Threads::defaultThreads()`.
+        size_t threads = 0;
+    };
+
+    /**
+     * Gets the parameters the kernels currently run with. They must only be
+     * changed while no kernel is running.
+     *
+     * @return The current parameters.
+     */
+    inline Parameters& parameters() {
+        static Parameters current;
+        return current;
+    }
+
+    /**
+     * Whether a set of parameters can be used by the kernels, which guards
+     * against hand-edited or truncated tuning files.
+     *
+     * @param tuning The parameters to check.
+     * @param mr The height of the register tiles, see `Kernels::Blocking::MR`.
+     * @return True if the parameters are usable.
+     */
+    inline bool isValid(const Parameters& tuning, const size_t mr) {
+        return tuning.mc >= mr && tuning.mc % mr == 0 && tuning.kc > 0 && tuning.nc > 0
+            && (tuning.gemvRows == 2 || tuning.gemvRows == 4 || tuning.gemvRows == 8);
+    }
+
+    /**
+     * Writes parameters to a tuning file. The file records the instruction
+     * set and the number of cores they were measured with, since they don't
+     * carry over to other machines or builds.
+     *
+     * @param file The path of the tuning file.
+     * @param tuning The parameters to save.
+     * @param isa The instruction set the kernels run on.
+     * @param cores The number of cores of this machine.
+     * @return True if the file could be written.
+     */
+    inline bool save(const std::string& file, const Parameters& tuning, const std::string& isa, const size_t cores) {
+        std::ofstream stream{file};
+        if (!stream) return false;
+
+        stream << "isa " << isa << std::endl
+               << "cores " << cores << std::endl
+               << "mc " << tuning.mc << std::endl
+               << "kc " << tuning.kc << std::endl
+               << "nc " << tuning.nc << std::endl
+               << "gemvRows " << tuning.gemvRows << std::endl
+               << "parallelWork " << tuning.parallelWork << std::endl
+               << "threads " << tuning.threads << std::endl;
+        return static_cast<bool>(stream);
+    }
+
+    /**
+     * Reads parameters from a tuning file written by `save()`. The file is
+     * ignored if it was measured on another instruction set or number of
+     * cores, or if it holds parameters that aren't valid. Unknown keys are
+     * skipped.
+     *
+     * @param file The path of the tuning file.
+     * @param isa The instruction set the kernels run on.
+     * @param cores The number of cores of this machine.
+     * @param mr The height of the register tiles, see `Kernels::Blocking::MR`.
+     * @param tuning Where to store the parameters.
+     * @return True if the parameters were loaded.
+     */
+    inline bool load(const std::string& file, const std::string& isa, const size_t cores, const size_t mr, Parameters& tuning) {
+        std::ifstream stream{file};
+        if (!stream) return false;
+
+        Parameters loaded = tuning;
+        std::string key;
+        std::string fileIsa;
+        size_t fileCores = 0;
+
+        while (stream >> key) {
+            if (key == "isa") stream >> fileIsa;
+            else if (key == "cores") stream >> fileCores;
+            else if (key == "mc") stream >> loaded.mc;
+            else if (key == "kc") stream >> loaded.kc;
+            else if (key == "nc") stream >> loaded.nc;
+            else if (key == "gemvRows") stream >> loaded.gemvRows;
+            else if (key == "parallelWork") stream >> loaded.parallelWork;
+            else if (key == "threads") stream >> loaded.threads;
+            else stream.ignore(256, '\n');
+
+            if (!stream) return false;
+        }
+
+        if (fileIsa != isa || fileCores != cores || !isValid(loaded, mr)) return false;
+        tuning = loaded;
+        return true;
+    }
+} // Tuning
@@ -0,0 +1,210 @@
+#pragma once
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+#include "simd.hpp"
+
+namespace Unrolled {
+    /**
+     * Products with at most this many multiply-adds use the kernels below
+     * instead of the general ones in `Kernels`. Small products spend most of
+     * their time on loop control and on deciding between packing, tails and
+     * threads. These kernels take every size as a template parameter and are
+     * unrolled completely at compile time instead. This bound covers the
+     * 10x300 output layer. Larger products would only bloat the code.
+     *
+     * CBLAS builds run every product on the library instead, so that it can
+     * be compared against the native kernels on the same work. Builds that
+     * dispatch the kernels at run time skip this tier, too, so it only
+     * exists in builds for one architecture, like `make ARCH=native`. These
+     * kernels are inlined into their callers, so they'd only ever run on
+     * the baseline instruction set, and the dispatched ones are faster for
+     * the output layer even on SSE2.
+     */
+    constexpr size_t maxWork = 4096;
+
+    /**
+     * Whether an `n * k` by `k * m` product is small enough for the unrolled
+     * kernels.
+     *
+     * @tparam N The number of rows in the result.
+     * @tparam K The length of the dot products.
+     * @tparam M The number of columns in the result.
+     */
+#if defined(KERNELS_CBLAS) || defined(KERNELS_DISPATCH)
+    template<size_t N, size_t K, size_t M>
+    constexpr bool fits = false;
+#else
+    template<size_t N, size_t K, size_t M>
+    constexpr bool fits = N * K * M <= maxWork;
+#endif
+
+    /**
+     * Calls `function(std::integral_constant<size_t, I>{})` for every `I` in
+     * the index sequence, see `repeat()`.
+     *
+     * @tparam F The function type.
+     * @tparam I The indices.
+     * @param function The function to call.
+     */
+    template<typename F, size_t... I>
+    void repeat(const F& function, std::index_sequence<I...>) {
+        (function(std::integral_constant<size_t, I>{}), ...);
+    }
+
+    /**
+     * Calls `function(std::integral_constant<size_t, I>{})` for every `I` in
+     * `[0, Count)`. Each call is a separate statement with a constant index,
+     * so no loop is left for the compiler to unroll.
+     *
+     * @tparam Count The number of calls.
+     * @tparam F The function type.
+     * @param function The function to call.
+     */
+    template<size_t Count, typename F>
+    void repeat(const F& function) {
+        repeat(function, std::make_index_sequence<Count>{});
+    }
+
+    /**
+     * Computes the dot product of `K` contiguous entries. Full vectors
+     * alternate between two accumulators to hide the latency of the fused
+     * multiply-adds, and the last `K % W` entries are added one by one.
+     *
+     * @tparam T The entry type.
+     * @tparam K The number of entries.
+     * @param a Pointer to the first vector.
+     * @param x Pointer to the second vector.
+     * @return The dot product.
+     */
+    template<typename T, size_t K>
+    T dot(const T* a, const T* x) {
+        using Vector = Simd::Vector<T>;
+        using Register = typename Vector::Register;
+        constexpr size_t W = Vector::width;
+        constexpr size_t Chunks = K / W;
+
+        Register sums[2] = {Vector::zero(), Vector::zero()};
+        repeat<Chunks>([&](auto chunk) {
+            constexpr size_t p = decltype(chunk)::value * W;
+            sums[p / W % 2] = Vector::fma(Vector::load(a + p), Vector::load(x + p), sums[p / W % 2]);
+        });
+
+        T result = Vector::sum(Vector::add(sums[0], sums[1]));
+        repeat<K - Chunks * W>([&](auto tail) {
+            constexpr size_t p = Chunks * W + decltype(tail)::value;
+            result += a[p] * x[p];
+        });
+        return result;
+    }
+
+    /**
+     * Computes `y += alpha * x` for `M` contiguous entries.
+     *
+     * @tparam T The entry type.
+     * @tparam M The number of entries.
+     * @param alpha The scalar to multiply x by.
+     * @param x Pointer to the first entry of x.
+     * @param y Pointer to the first entry of y.
+     */
+    template<typename T, size_t M>
+    void axpy(const T alpha, const T* x, T* y) {
+        using Vector = Simd::Vector<T>;
+        constexpr size_t W = Vector::width;
+        constexpr size_t Chunks = M / W;
+
+        const auto scalar = Vector::broadcast(alpha);
+        repeat<Chunks>([&](auto chunk) {
+            constexpr size_t j = decltype(chunk)::value * W;
+            Vector::store(y + j, Vector::fma(scalar, Vector::load(x + j), Vector::load(y + j)));
+        });
+        repeat<M - Chunks * W>([&](auto tail) {
+            constexpr size_t j = Chunks * W + decltype(tail)::value;
+            y[j] += alpha * x[j];
+        });
+    }
+
+    /**
+     * Computes `y += A * x` for a row-major `N * K` matrix A, one unrolled
+     * dot product per row.
+     *
+     * @tparam T The entry type.
+     * @tparam N The number of rows in A and entries in y.
+     * @tparam K The number of columns in A and entries in x.
+     * @tparam LDA The row stride of A.
+     * @param a Pointer to the first entry of A.
+     * @param x Pointer to the first entry of x.
+     * @param y Pointer to the first entry of y.
+     */
+    template<typename T, size_t N, size_t K, size_t LDA>
+    void gemv(const T* a, const T* x, T* y) {
+        repeat<N>([&](auto row) {
+            constexpr size_t i = decltype(row)::value;
+            y[i] += dot<T, K>(a + i * LDA, x);
+        });
+    }
+
+    /**
+     * Computes `y += A^T * x` for a row-major `N * K` matrix A by adding up
+     * the rows of A scaled by the entries of x, like
+     * `Kernels::gemvTransposed()`.
+     *
+     * @tparam T The entry type.
+     * @tparam N The number of rows in A and entries in x.
+     * @tparam K The number of columns in A and entries in y.
+     * @tparam LDA The row stride of A.
+     * @param a Pointer to the first entry of A.
+     * @param x Pointer to the first entry of x.
+     * @param y Pointer to the first entry of y.
+     */
+    template<typename T, size_t N, size_t K, size_t LDA>
+    void gemvTransposed(const T* a, const T* x, T* y) {
+        repeat<N>([&](auto row) {
+            constexpr size_t i = decltype(row)::value;
+            axpy<T, K>(x[i], a + i * LDA, y);
+        });
+    }
+
+    /**
+     * Computes `C += A * B` for row-major matrices, adding every row of B
+     * scaled by the matching entry of A to the rows of C.
+     *
+     * @tparam T The entry type.
+     * @tparam N The number of rows in A and C.
+     * @tparam K The number of columns in A and rows in B.
+     * @tparam M The number of columns in B and C.
+     * @tparam LDA The row stride of A.
+     * @tparam LDB The row stride of B.
+     * @tparam LDC The row stride of C.
+     * @param a Pointer to the first entry of A.
+     * @param b Pointer to the first entry of B.
+     * @param c Pointer to the first entry of C.
+     */
+    template<typename T, size_t N, size_t K, size_t M, size_t LDA, size_t LDB, size_t LDC>
+    void gemm(const T* a, const T* b, T* c) {
+        repeat<N>([&](auto row) {
+            constexpr size_t i = decltype(row)::value;
+            gemvTransposed<T, K, M, LDB>(b, a + i * LDA, c + i * LDC);
+        });
+    }
+
+    /**
+     * Computes `A += alpha * x * y^T` for a row-major `N * M` matrix A.
+     *
+     * @tparam T The entry type.
+     * @tparam N The number of rows in A and entries in x.
+     * @tparam M The number of columns in A and entries in y.
+     * @tparam LDA The row stride of A.
+     * @param alpha The scalar to multiply the outer product by.
+     * @param x Pointer to the first entry of x.
+     * @param y Pointer to the first entry of y.
+     * @param a Pointer to the first entry of A.
+     */
+    template<typename T, size_t N, size_t M, size_t LDA>
+    void ger(const T alpha, const T* x, const T* y, T* a) {
+        repeat<N>([&](auto row) {
+            constexpr size_t i = decltype(row)::value;
+            axpy<T, M>(alpha * x[i], y, a + i * LDA);
+        });
+    }
+} // Unrolled
@@ -0,0 +1,244 @@
+#pragma once
+#include <cstddef>
+#include <stdexcept>
+#include <type_traits>
+
+namespace Matrix {
+    /**
+     * Non-owning view of a `rows * cols` block of row-major entries, where
+     * consecutive rows start `stride` entries apart. Views are cheap to copy
+     * and are how the kernels receive their operands, so anything that can
+     * produce a view (a whole matrix, a few of its rows, a block of a larger
+     * buffer) can be passed to a kernel without copying.
+     *
+     * Element access through a view is unchecked. Slicing is checked, since
+     * it happens outside of the inner loops.
+     *
+     * @tparam T The entry type. Use a const type for a read-only view.
+     */
+    template<typename T>
+    class MatrixView {
+    public:
+        /**
+         * Constructs a view over existing entries.
+         *
+         * @param data Pointer to the entry at `(0, 0)`.
+         * @param rows The number of rows.
+         * @param cols The number of columns.
+         * @param stride The distance between the starts of two consecutive rows.
+         */
+        MatrixView(T* data, const size_t rows, const size_t cols, const size_t stride) noexcept :
+            _data{data},
+            _rows{rows},
+            _cols{cols},
+            _stride{stride} {
+        }
+
+        /**
+         * Converts a mutable view into a read-only one.
+         *
+         * @tparam U The entry type of the mutable view.
+         * @param view The mutable view.
+         */
+        template<typename U, typename = std::enable_if_t<std::is_same<const U, T>::value && !std::is_same<U, T>::value>>
+        MatrixView(const MatrixView<U>& view) noexcept :
+            MatrixView{view.data(), view.rows(), view.cols(), view.stride()} {
+        }
+
+        T* data() const noexcept {
+            return _data;
+        }
+
+        size_t rows() const noexcept {
+            return _rows;
+        }
+
+        size_t cols() const noexcept {
+            return _cols;
+        }
+
+        size_t stride() const noexcept {
+            return _stride;
+        }
+
+        /**
+         * Whether the rows follow each other without any gaps, in which case
+         * the view can be treated as one flat array of `rows * cols` entries.
+         *
+         * @return True if the entries are contiguous.
+         */
+        bool isContiguous() const noexcept {
+            return _stride == _cols || _rows == 1;
+        }
+
+        /**
+         * Gets the entry at `(i, j)` without any bounds checking.
+         *
+         * @param i The row index.
+         * @param j The column index.
+         * @return The entry at `(i, j)`.
+         */
+        T& operator()(const size_t i, const size_t j) const noexcept {
+            return _data[i * _stride + j];
+        }
+
+        /**
+         * Gets a pointer to the first entry of row `i` without any bounds
+         * checking.
+         *
+         * @param i The row index.
+         * @return The `i`-th row.
+         */
+        T* row(const size_t i) const noexcept {
+            return _data + i * _stride;
+        }
+
+        /**
+         * Gets a view of rows `[begin, end)`.
+         *
+         * @param begin The first row.
+         * @param end One past the last row.
+         * @throws std::out_of_range
+         * @return The view of the rows.
+         */
+        MatrixView rowRange(const size_t begin, const size_t end) const {
+            return block(begin, 0, end - begin, _cols);
+        }
+
+        /**
+         * Gets a view of columns `[begin, end)`.
+         *
+         * @param begin The first column.
+         * @param end One past the last column.
+         * @throws std::out_of_range
+         * @return The view of the columns.
+         */
+        MatrixView colRange(const size_t begin, const size_t end) const {
+            return block(0, begin, _rows, end - begin);
+        }
+
+        /**
+         * Gets a view of the `rows * cols` block whose top left entry is at
+         * `(row, col)`.
+         *
+         * @param row The first row of the block.
+         * @param col The first column of the block.
+         * @param rows The number of rows in the block.
+         * @param cols The number of columns in the block.
+         * @throws std::out_of_range
+         * @return The view of the block.
+         */
+        MatrixView block(const size_t row, const size_t col, const size_t rows, const size_t cols) const {
+            if (row > _rows || rows > _rows - row) throw std::out_of_range{"`rows` are out of range!"};
+            if (col > _cols || cols > _cols - col) throw std::out_of_range{"`cols` are out of range!"};
+            return {_data + row * _stride + col, rows, cols, _stride};
+        }
+
+    private:
+        T* _data;
+        size_t _rows;
+        size_t _cols;
+        size_t _stride;
+    };
+
+    /**
+     * Read-only view of a block of entries.
+     *
+     * @tparam T The entry type.
+     */
+    template<typename T>
+    using ConstMatrixView = MatrixView<const T>;
+
+    /**
+     * Non-owning, read-only view of a `rows * cols` matrix in compressed
+     * sparse row (CSR) form. The non-zero entries of row `i` are
+     * `values[offsets[i]]` to `values[offsets[i + 1] - 1]`, in order of their
+     * column indices, which are stored alongside in `columns`. Like
+     * `MatrixView`, this is how the kernels receive sparse operands.
+     *
+     * @tparam T The entry type.
+     */
+    template<typename T>
+    class SparseView {
+    public:
+        /**
+         * Constructs a view over existing compressed rows.
+         *
+         * @param rows The number of rows.
+         * @param cols The number of columns.
+         * @param offsets The `rows + 1` offsets of the rows into `columns` and `values`.
+         * @param columns The column index of every non-zero entry.
+         * @param values Every non-zero entry.
+         */
+        SparseView(
+            const size_t rows,
+            const size_t cols,
+            const size_t* offsets,
+            const size_t* columns,
+            const T* values
+        ) noexcept :
+            _rows{rows},
+            _cols{cols},
+            _offsets{offsets},
+            _columns{columns},
+            _values{values} {
+        }
+
+        size_t rows() const noexcept {
+            return _rows;
+        }
+
+        size_t cols() const noexcept {
+            return _cols;
+        }
+
+        /**
+         * Gets the number of non-zero entries in the whole view.
+         *
+         * @return The number of non-zero entries.
+         */
+        size_t nonZeros() const noexcept {
+            return _offsets[_rows] - _offsets[0];
+        }
+
+        /**
+         * Gets the number of non-zero entries in row `i` without any bounds
+         * checking.
+         *
+         * @param i The row index.
+         * @return The number of non-zero entries.
+         */
+        size_t size(const size_t i) const noexcept {
+            return _offsets[i + 1] - _offsets[i];
+        }
+
+        /**
+         * Gets a pointer to the column indices of row `i` without any bounds
+         * checking.
+         *
+         * @param i The row index.
+         * @return The column indices of the non-zero entries.
+         */
+        const size_t* columns(const size_t i) const noexcept {
+            return _columns + _offsets[i];
+        }
+
+        /**
+         * Gets a pointer to the non-zero entries of row `i` without any
+         * bounds checking.
+         *
+         * @param i The row index.
+         * @return The non-zero entries.
+         */
+        const T* values(const size_t i) const noexcept {
+            return _values + _offsets[i];
+        }
+
+    private:
+        size_t _rows;
+        size_t _cols;
+        const size_t* _offsets;
+        const size_t* _columns;
+        const T* _values;
+    };
+} // Matrix
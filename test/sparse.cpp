@@ -0,0 +1,217 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <random>
+#include <string>
+#include <utility>
+#include "math.hpp"
+#include "neuralnet.hpp"
+
+/**
+ * Checks that the sparse input path of the network matches the dense one.
+ *
+ * The dense network is given every input with `Math::pixelOffset` already
+ * added, so none of its inputs are 0 and it never takes a sparse path. The
+ * sparse network is given the same inputs without the offset, and adds it
+ * back itself, folded into its bias. Both start from the same weights, so
+ * they should agree up to rounding on every query and every training step.
+ * The inputs range from far sparser to far denser than the MNIST digits, so
+ * both sides of the density limits in `src/matrix.hpp` are taken.
+ *
+ * Usage: `sparse <scratch file>`, where the scratch file holds the weights.
+ */
+
+constexpr size_t inputSize = 784;
+constexpr size_t hiddenSize = 300;
+constexpr size_t outputSize = 10;
+constexpr size_t samples = 500;
+constexpr double tolerance = 1e-9;
+
+using Network = NeuralNetwork::NeuralNetwork<inputSize, hiddenSize, outputSize>;
+using TrainingSet = NeuralNetwork::TrainingSet<inputSize, outputSize>;
+
+/**
+ * Builds a random training set, with the density of every input drawn
+ * between 2% and 60%.
+ *
+ * @param generator The random number generator.
+ * @param offset The offset added to every input.
+ * @return The sparse training set, and the same set with the offset added.
+ */
+std::pair<TrainingSet, TrainingSet> randomTrainingSets(std::mt19937& generator, const double offset) {
+    std::uniform_real_distribution<double> density{0.02, 0.6};
+    std::uniform_real_distribution<double> uniform{0, 1};
+    std::uniform_int_distribution<int> pixel{1, 255};
+    std::uniform_int_distribution<size_t> value{0, outputSize - 1};
+
+    TrainingSet sparseSet(samples);
+    TrainingSet denseSet(samples);
+    for (size_t n = 0; n < samples; ++n) {
+        auto& sparseLabel = sparseSet[n];
+        sparseLabel.value = value(generator);
+        for (size_t i = 0; i < outputSize; ++i) {
+            sparseLabel.label[i][0] = sparseLabel.value == i ? 1 : 0.01;
+        }
+
+        const double p = density(generator);
+        for (size_t i = 0; i < inputSize; ++i) {
+            sparseLabel.input[i][0] = uniform(generator) < p ? Math::normalizePixel(pixel(generator)) : 0;
+        }
+
+        auto& denseLabel = denseSet[n];
+        denseLabel = sparseLabel;
+        for (size_t i = 0; i < inputSize; ++i) denseLabel.input[i][0] += offset;
+    }
+
+    return {std::move(sparseSet), std::move(denseSet)};
+}
+
+/**
+ * Reports a failed check if the two values are further apart than the
+ * tolerance, relative to their size.
+ *
+ * @param name The name of the value.
+ * @param sparse The value from the sparse network.
+ * @param dense The value from the dense network.
+ * @return True if the values match.
+ */
+bool matches(const std::string& name, const double sparse, const double dense) {
+    if (std::abs(sparse - dense) <= tolerance * std::max(1.0, std::abs(dense))) return true;
+    std::printf("FAIL %s: sparse %.17g, dense %.17g\n", name.c_str(), sparse, dense);
+    return false;
+}
+
+/**
+ * Compares the results of both networks on every input, one input at a
+ * time and as batches.
+ *
+ * @param sparseNetwork The network with the offset folded into its bias.
+ * @param denseNetwork The network given the offset with its inputs.
+ * @param sparseSet The inputs without the offset.
+ * @param denseSet The inputs with the offset.
+ * @return True if every result matches.
+ */
+bool queriesMatch(
+    const Network& sparseNetwork,
+    const Network& denseNetwork,
+    const TrainingSet& sparseSet,
+    const TrainingSet& denseSet
+) {
+    constexpr size_t batchSize = 20;
+    static_assert(samples % batchSize == 0, "The batches have to cover every input!");
+    NeuralNetwork::Batch<inputSize, batchSize> sparseBatch{};
+    NeuralNetwork::Batch<inputSize, batchSize> denseBatch{};
+
+    size_t mismatches = 0;
+    for (size_t begin = 0; begin < samples; begin += batchSize) {
+        for (size_t i = 0; i < batchSize; ++i) {
+            sparseBatch.setColumn(i, sparseSet[begin + i].input);
+            denseBatch.setColumn(i, denseSet[begin + i].input);
+        }
+        const auto sparseResults = sparseNetwork.query(sparseBatch);
+        const auto denseResults = denseNetwork.query(denseBatch);
+
+        for (size_t i = 0; i < batchSize; ++i) {
+            const size_t result = denseNetwork.query(denseSet[begin + i].input);
+            if (sparseNetwork.query(sparseSet[begin + i].input) != result) mismatches++;
+            if (sparseResults[i] != result || denseResults[i] != result) mismatches++;
+        }
+    }
+
+    if (mismatches == 0) return true;
+    std::printf("FAIL queries: %zu mismatched results\n", mismatches);
+    return false;
+}
+
+/**
+ * Trains both networks on the same inputs and compares their statistics,
+ * which depend on the weights before every step.
+ *
+ * @param epoch The name of the training run.
+ * @param sparseNetwork The network with the offset folded into its bias.
+ * @param denseNetwork The network given the offset with its inputs.
+ * @param sparseSet The inputs without the offset.
+ * @param denseSet The inputs with the offset.
+ * @return True if every statistic matches.
+ */
+bool trainingMatches(
+    const std::string& epoch,
+    Network& sparseNetwork,
+    Network& denseNetwork,
+    const TrainingSet& sparseSet,
+    const TrainingSet& denseSet
+) {
+    sparseNetwork.train(sparseSet);
+    denseNetwork.train(denseSet);
+    const auto& sparse = sparseNetwork.trainingStats();
+    const auto& dense = denseNetwork.trainingStats();
+
+    bool ok = matches(epoch + " loss", sparse.loss, dense.loss);
+    ok &= matches(epoch + " input gradient norm", sparse.inputGradientNorm, dense.inputGradientNorm);
+    ok &= matches(epoch + " hidden gradient norm", sparse.hiddenGradientNorm, dense.hiddenGradientNorm);
+    return ok;
+}
+
+/**
+ * Compares the weights of both networks through their dumps. The dumps only
+ * keep about 6 digits, so they're compared at that precision.
+ *
+ * @param sparseNetwork The network with the offset folded into its bias.
+ * @param denseNetwork The network given the offset with its inputs.
+ * @param file The scratch file.
+ * @return True if every weight matches.
+ */
+bool weightsMatch(const Network& sparseNetwork, const Network& denseNetwork, const std::string& file) {
+    const std::string sparseFile = file + ".sparse";
+    sparseNetwork.dumpWeightsToFile(sparseFile);
+    denseNetwork.dumpWeightsToFile(file);
+
+    std::ifstream sparseStream{sparseFile};
+    std::ifstream denseStream{file};
+    size_t mismatches = 0;
+    size_t count = 0;
+    for (double sparse, dense; sparseStream >> sparse && denseStream >> dense; ++count) {
+        if (std::abs(sparse - dense) > 1e-5 * std::max(1.0, std::abs(dense))) mismatches++;
+    }
+    std::remove(sparseFile.c_str());
+
+    if (count != inputSize * hiddenSize + hiddenSize * outputSize) {
+        std::printf("FAIL weights: only read %zu of them\n", count);
+        return false;
+    }
+    if (mismatches == 0) return true;
+    std::printf("FAIL weights: %zu mismatched weights\n", mismatches);
+    return false;
+}
+
+int main(int argc, char** argv) {
+    if (argc != 2) {
+        std::printf("Usage: %s <scratch file>\n", argv[0]);
+        return 2;
+    }
+    const std::string file = argv[1];
+
+    std::mt19937 generator{42};
+    const auto [sparseSet, denseSet] = randomTrainingSets(generator, Math::pixelOffset);
+    const auto [otherSparseSet, otherDenseSet] = randomTrainingSets(generator, Math::pixelOffset);
+
+    // Start both networks from the same weights. The loaded weights are
+    // rounded by the dump, but they're rounded the same for both.
+    Network sparseNetwork{0.1, false, Kernels::Accuracy::Exact, Math::pixelOffset};
+    Network denseNetwork{0.1};
+    sparseNetwork.dumpWeightsToFile(file);
+    bool ok = sparseNetwork.loadWeightsFromFile(file) && denseNetwork.loadWeightsFromFile(file);
+
+    // The second epoch runs on the weights with the offset updates of the
+    // first one folded in.
+    ok &= queriesMatch(sparseNetwork, denseNetwork, sparseSet, denseSet);
+    ok &= trainingMatches("first epoch", sparseNetwork, denseNetwork, sparseSet, denseSet);
+    ok &= queriesMatch(sparseNetwork, denseNetwork, otherSparseSet, otherDenseSet);
+    ok &= trainingMatches("second epoch", sparseNetwork, denseNetwork, otherSparseSet, otherDenseSet);
+    ok &= weightsMatch(sparseNetwork, denseNetwork, file);
+    std::remove(file.c_str());
+
+    std::printf("%s: sparse and dense inputs %s\n", argv[0], ok ? "match" : "differ");
+    return ok ? 0 : 1;
+}